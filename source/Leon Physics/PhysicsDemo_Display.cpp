@@ -117,7 +117,7 @@ void PhysicsDemo::display()
 				const lt::CollisionShape &curShape = **shapeIter;
 
 				glPushMatrix();
-					curBody.getTransform().getOpenGLMatrix(transform);
+					world.getInterpolatedTransform(curBody).getOpenGLMatrix(transform);
 					glMultMatrixf(transform);
 					curShape.getOffset().getOpenGLMatrix(transform);
 					glMultMatrixf(transform);
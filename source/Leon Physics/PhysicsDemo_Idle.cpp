@@ -5,8 +5,6 @@
 void PhysicsDemo::idle()
 {
 	calcFrameTime();
-	// Cap the update rate to 30FPS.
-	m_frameTime = (m_frameTime > 0.032) ? 0.032f : m_frameTime;
 
 	Uint8 *keyState = SDL_GetKeyState(NULL);
 
@@ -37,10 +35,10 @@ void PhysicsDemo::idle()
 	// Move stuff
 	lt::Scalar deltaZ = (keyState[SDLK_t] - keyState[SDLK_y]) * 100 * m_frameTime;
 
-	// Physics
+	// Physics, in fixed steps whatever the frame rate
 	if(!keyState[SDLK_SPACE])
 	{
-		world.stepSimulation(m_frameTime);
+		world.advanceSimulation(m_frameTime);
 	}
 
 	m_lastMouseX = m_mouseX;
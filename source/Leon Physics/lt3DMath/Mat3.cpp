@@ -91,7 +91,7 @@ Mat3& Mat3::invert()
 	Scalar cg = m_data[2]*m_data[6];
 
 	// Calculate the determinant
-	Scalar det = (ae*m_data[8]) - (af*m_data[7]) +
+	Scalar det = (ae*m_data[8]) - (af*m_data[7]) -
 			        (bd*m_data[8]) + (cd*m_data[7]) +
 			        (bg*m_data[5]) - (cg*m_data[4]);
 		
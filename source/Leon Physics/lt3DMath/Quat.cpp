@@ -93,10 +93,10 @@ Quat& Quat::operator *= (const Quat &rhs)
 //
 //}
 
-//const Scalar Quat::dot(const Quat &rhs) const
-//{
-//
-//}
+const Scalar Quat::dot(const Quat &rhs) const
+{
+	return x*rhs.x + y*rhs.y + z*rhs.z + w*rhs.w;
+}
 
 const Scalar Quat::length() const
 {
@@ -133,10 +133,10 @@ const Vec3 Quat::getAxis() const
 	return Vec3(x / commonTerm, y / commonTerm, z / commonTerm);
 }
 
-//const Quat& Quat::inverse() const
-//{
-//
-//}
+const Quat Quat::inverse() const
+{
+	return Quat(-x, -y, -z, w);
+}
 
 Quat& Quat::normalize()
 {
@@ -74,7 +74,18 @@ public:
 	Quat& operator *= (const Quat &rhs);
 
 	//const Quat& operator *= (const Scalar rhs);
-	//const Scalar dot(const Quat &rhs) const;
+
+	////////////////////////////////////////////////////////////
+	/// @brief Calculates the dot product of two quaternions. 
+	/// For unit quaternions it's the cosine of half the angle 
+	/// between them.
+	///
+	/// @param rhs right operand (a quaternion)
+	///
+	/// @return Dot product.
+	///
+    ////////////////////////////////////////////////////////////
+	const Scalar dot(const Quat &rhs) const;
 
 	////////////////////////////////////////////////////////////
 	/// @brief Get the length of the quaternion
@@ -114,7 +125,14 @@ public:
     ////////////////////////////////////////////////////////////
 	const Vec3 getAxis() const;
 
-	//const Quat& inverse() const;
+	////////////////////////////////////////////////////////////
+	/// @brief Get the inverse of the quaternion. Assumes the 
+	/// quaternion is normalized, so it's just the conjugate.
+	///
+	/// @return Inverse of the quaternion
+	/// 
+    ////////////////////////////////////////////////////////////
+	const Quat inverse() const;
 
 	////////////////////////////////////////////////////////////
 	/// @brief Normalize the quaternion. Though a quaternion 
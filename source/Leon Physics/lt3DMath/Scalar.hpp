@@ -5,6 +5,10 @@
 
 // Make sure math knows what Scalar is!
 #define scalar_pow powf
+#define scalar_sqrt sqrtf
+#define scalar_abs fabsf
+#define scalar_atan2 atan2f
+#define scalar_fmod fmodf
 
 namespace lt
 {
@@ -173,8 +173,8 @@ const Vec3 Transform::transformInvP(const Vec3& point) const
 {
 	Vec3 temp = point;
 	temp.x -= m_data[3];
-	temp.x -= m_data[7];
-	temp.x -= m_data[11];
+	temp.y -= m_data[7];
+	temp.z -= m_data[11];
 		
 	return Vec3(
 		temp.x*m_data[0] + temp.y*m_data[4] + temp.z*m_data[8],
@@ -183,4 +183,14 @@ const Vec3 Transform::transformInvP(const Vec3& point) const
 	);
 }
 
+const Vec3 Transform::transformInvV(const Vec3& vector) const
+{
+	return Vec3(
+		vector.x*m_data[0] + vector.y*m_data[4] + vector.z*m_data[8],
+		vector.x*m_data[1] + vector.y*m_data[5] + vector.z*m_data[9],
+		vector.x*m_data[2] + vector.y*m_data[6] + vector.z*m_data[10],
+		0
+	);
+}
+
 } // namespace lt
\ No newline at end of file
@@ -204,12 +204,12 @@ public:
 	////////////////////////////////////////////////////////////
 	/// @brief Transform the given vector by the transformational
 	/// inverse of this matrix. Different to transformInvP(...) as it 
-	/// ignores rotation
+	/// ignores translation
 	///
-	/// @return Transformed point.
+	/// @return Transformed vector.
 	///
 	////////////////////////////////////////////////////////////
-	//const Vec3 transformInvV(const Vec3& vector) const;
+	const Vec3 transformInvV(const Vec3& vector) const;
 
 private:
 	Scalar m_data[16];
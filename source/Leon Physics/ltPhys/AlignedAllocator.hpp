@@ -0,0 +1,84 @@
+#ifndef LTPHYS_ALIGNEDALLOCATOR_HPP
+#define LTPHYS_ALIGNEDALLOCATOR_HPP
+
+#include <cstddef>
+#include <new>
+
+namespace lt
+{
+
+/** Alignment of arrays worked on a SIMD register at a time, enough for AVX */
+const std::size_t SIMD_ALIGNMENT = 32;
+
+////////////////////////////////////////////////////////////
+/// @brief Allocator for std::vector that starts the array on
+/// a SIMD_ALIGNMENT boundary.
+///
+/// Over-allocates and keeps the offset to the real block
+/// just before the aligned one.
+///
+/// @author Leon Turpin
+/// @date November 2014
+////////////////////////////////////////////////////////////
+template <typename T>
+class AlignedAllocator
+{
+public:
+	typedef T value_type;
+	typedef T* pointer;
+	typedef const T* const_pointer;
+	typedef T& reference;
+	typedef const T& const_reference;
+	typedef std::size_t size_type;
+	typedef std::ptrdiff_t difference_type;
+
+	template <typename U>
+	struct rebind
+	{
+		typedef AlignedAllocator<U> other;
+	};
+
+	AlignedAllocator() {}
+
+	template <typename U>
+	AlignedAllocator(const AlignedAllocator<U>&) {}
+
+	T* allocate(std::size_t count)
+	{
+		std::size_t size = count * sizeof(T) + SIMD_ALIGNMENT + sizeof(std::size_t);
+		char *block = static_cast<char*>(::operator new(size));
+
+		// Room for the offset, then round up to the boundary
+		std::size_t address = reinterpret_cast<std::size_t>(block) + sizeof(std::size_t);
+		std::size_t aligned = (address + SIMD_ALIGNMENT - 1) & ~(SIMD_ALIGNMENT - 1);
+
+		char *data = reinterpret_cast<char*>(aligned);
+		reinterpret_cast<std::size_t*>(data)[-1] = data - block;
+
+		return reinterpret_cast<T*>(data);
+	}
+
+	void deallocate(T* data, std::size_t)
+	{
+		char *aligned = reinterpret_cast<char*>(data);
+		::operator delete(aligned - reinterpret_cast<std::size_t*>(aligned)[-1]);
+	}
+
+	std::size_t max_size() const { return (std::size_t(-1) - SIMD_ALIGNMENT - sizeof(std::size_t)) / sizeof(T); }
+
+	template <typename U>
+	void construct(U* data, const U& value) { new (data) U(value); }
+
+	template <typename U>
+	void destroy(U* data) { data->~U(); }
+};
+
+template <typename T, typename U>
+inline bool operator==(const AlignedAllocator<T>&, const AlignedAllocator<U>&) { return true; }
+
+template <typename T, typename U>
+inline bool operator!=(const AlignedAllocator<T>&, const AlignedAllocator<U>&) { return false; }
+
+} // namespace lt
+
+#endif // LTPHYS_ALIGNEDALLOCATOR_HPP
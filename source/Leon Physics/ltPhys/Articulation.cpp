@@ -0,0 +1,741 @@
+#include "Articulation.hpp"
+
+#include <math.h>
+
+namespace lt
+{
+
+typedef Articulation::SpatialVector SpatialVector;
+typedef Articulation::SpatialMatrix SpatialMatrix;
+
+static const Scalar RAD_TO_DEG = 57.2957795f;
+
+static const SpatialVector spatial(const Vec3 &angular, const Vec3 &linear)
+{
+	SpatialVector result;
+	result.angular = angular;
+	result.linear = linear;
+	return result;
+}
+
+static const SpatialVector spatialAdd(const SpatialVector &a, const SpatialVector &b)
+{
+	return spatial(a.angular + b.angular, a.linear + b.linear);
+}
+
+static const SpatialVector spatialScale(const SpatialVector &a, const Scalar &scale)
+{
+	return spatial(a.angular * scale, a.linear * scale);
+}
+
+// A motion dotted with a force is the power the force puts into the motion
+static const Scalar spatialDot(const SpatialVector &a, const SpatialVector &b)
+{
+	return a.angular.dot(b.angular) + a.linear.dot(b.linear);
+}
+
+// How motion m changes when carried along by velocity v
+static const SpatialVector crossMotion(const SpatialVector &v, const SpatialVector &m)
+{
+	return spatial(v.angular.cross(m.angular), v.angular.cross(m.linear) + v.linear.cross(m.angular));
+}
+
+// How force f changes when carried along by velocity v
+static const SpatialVector crossForce(const SpatialVector &v, const SpatialVector &f)
+{
+	return spatial(v.angular.cross(f.angular) + v.linear.cross(f.linear), v.angular.cross(f.linear));
+}
+
+static void toArray(const SpatialVector &v, Scalar out[6])
+{
+	out[0] = v.angular.x; out[1] = v.angular.y; out[2] = v.angular.z;
+	out[3] = v.linear.x; out[4] = v.linear.y; out[5] = v.linear.z;
+}
+
+static const SpatialVector fromArray(const Scalar in[6])
+{
+	return spatial(Vec3(in[0], in[1], in[2]), Vec3(in[3], in[4], in[5]));
+}
+
+static const SpatialVector multiply(const SpatialMatrix &matrix, const SpatialVector &v)
+{
+	Scalar in[6], out[6];
+	toArray(v, in);
+
+	for (unsigned int row = 0; row < 6; row++)
+	{
+		out[row] = 0;
+
+		for (unsigned int col = 0; col < 6; col++)
+		{
+			out[row] += matrix.m[row][col] * in[col];
+		}
+	}
+
+	return fromArray(out);
+}
+
+static void setZero(SpatialMatrix &matrix)
+{
+	for (unsigned int row = 0; row < 6; row++)
+	{
+		for (unsigned int col = 0; col < 6; col++)
+		{
+			matrix.m[row][col] = 0;
+		}
+	}
+}
+
+// The spatial inertia of a body, built a column at a time from the momentum of each unit motion
+static const SpatialMatrix rigidInertia(const RigidBody &body)
+{
+	Mat3 inertiaWorld = body.getInvInertiaTensorWorld().inverse();
+	Scalar mass = body.getMass();
+	const Vec3 &centre = body.getPosition();
+
+	SpatialMatrix inertia;
+
+	for (unsigned int col = 0; col < 6; col++)
+	{
+		Scalar unit[6] = { 0, 0, 0, 0, 0, 0 };
+		unit[col] = 1;
+		SpatialVector motion = fromArray(unit);
+
+		// Momentum about the origin of the body moving with the unit motion
+		Vec3 momentum = (motion.linear + motion.angular.cross(centre)) * mass;
+		Vec3 angularMomentum = inertiaWorld * motion.angular + centre.cross(momentum);
+
+		Scalar column[6];
+		toArray(spatial(angularMomentum, momentum), column);
+
+		for (unsigned int row = 0; row < 6; row++)
+		{
+			inertia.m[row][col] = column[row];
+		}
+	}
+
+	return inertia;
+}
+
+// Solve matrix * x = b by gaussian elimination, for the floating base
+static const SpatialVector solveSpatial(const SpatialMatrix &matrix, const SpatialVector &b)
+{
+	Scalar a[6][7];
+
+	Scalar rhs[6];
+	toArray(b, rhs);
+
+	for (unsigned int row = 0; row < 6; row++)
+	{
+		for (unsigned int col = 0; col < 6; col++)
+		{
+			a[row][col] = matrix.m[row][col];
+		}
+
+		a[row][6] = rhs[row];
+	}
+
+	for (unsigned int col = 0; col < 6; col++)
+	{
+		// Pivot on the largest value left in the column
+		unsigned int pivot = col;
+		for (unsigned int row = col + 1; row < 6; row++)
+		{
+			if (scalar_abs(a[row][col]) > scalar_abs(a[pivot][col])) { pivot = row; }
+		}
+
+		for (unsigned int k = 0; k < 7; k++)
+		{
+			Scalar temp = a[col][k];
+			a[col][k] = a[pivot][k];
+			a[pivot][k] = temp;
+		}
+
+		if (a[col][col] == 0) { continue; }
+
+		for (unsigned int row = col + 1; row < 6; row++)
+		{
+			Scalar factor = a[row][col] / a[col][col];
+
+			for (unsigned int k = col; k < 7; k++)
+			{
+				a[row][k] -= factor * a[col][k];
+			}
+		}
+	}
+
+	Scalar x[6];
+	for (int row = 5; row >= 0; row--)
+	{
+		Scalar sum = a[row][6];
+
+		for (unsigned int k = row + 1; k < 6; k++)
+		{
+			sum -= a[row][k] * x[k];
+		}
+
+		x[row] = (a[row][row] != 0) ? sum / a[row][row] : 0;
+	}
+
+	return fromArray(x);
+}
+
+static const Vec3 rotate(const Quat &angle, const Vec3 &vector)
+{
+	return Transform(Vec3(0, 0, 0), angle) * Vec3(vector.x, vector.y, vector.z, 0);
+}
+
+// Turn angle by angularVelocity for timeStep
+static const Quat turn(const Quat &angle, const Vec3 &angularVelocity, const Scalar &timeStep)
+{
+	Scalar speed = angularVelocity.length();
+
+	if (speed == 0) { return angle; }
+
+	Quat result = Quat(angularVelocity / speed, speed * timeStep * RAD_TO_DEG) * angle;
+	return result.normalize();
+}
+
+// Small angle approximation of the rotation that takes from to to
+static const Vec3 rotationBetween(const Quat &from, const Quat &to)
+{
+	Quat difference = to * from.inverse();
+	Scalar sign = (difference.w < 0) ? -2.0f : 2.0f;
+
+	return Vec3(difference.x * sign, difference.y * sign, difference.z * sign);
+}
+
+// The motion of a body measured at the origin, from its velocity and angular velocity
+static const SpatialVector bodyMotion(const Vec3 &velocity, const Vec3 &angularVelocity, const Vec3 &centre)
+{
+	return spatial(angularVelocity, velocity - angularVelocity.cross(centre));
+}
+
+//--------------------------
+//	PUBLICS
+//--------------------------
+
+Articulation::Articulation(RigidBody &base)
+{
+	Link link;
+	link.body = &base;
+	link.parent = 0;
+	link.type = JOINT_REVOLUTE;
+	link.position = 0;
+	link.velocity = 0;
+	link.jointForce = 0;
+	link.isLimited = false;
+	link.lowerLimit = 0;
+	link.upperLimit = 0;
+
+	m_links.push_back(link);
+
+	m_jointDamping = 1.0f;
+}
+
+unsigned int Articulation::addLink(unsigned int parent, RigidBody &body, JointType type, const Vec3 &anchor, const Vec3 &axis)
+{
+	const RigidBody &parentBody = *m_links[parent].body;
+
+	Link link;
+	link.body = &body;
+	link.parent = parent;
+	link.type = type;
+
+	link.anchorInParent = parentBody.getTransform().transformInvP(anchor);
+	link.anchorInBody = body.getTransform().transformInvP(anchor);
+	link.axisInParent = parentBody.getTransform().transformInvV(axis.normalized());
+	link.restAngle = parentBody.getAngle().inverse() * body.getAngle();
+
+	link.position = 0;
+	link.velocity = 0;
+	link.jointForce = 0;
+	link.isLimited = false;
+	link.lowerLimit = 0;
+	link.upperLimit = 0;
+
+	m_links.push_back(link);
+
+	return m_links.size() - 1;
+}
+
+void Articulation::integrate(const Scalar &timeStep)
+{
+	// Sleeping articulations keep still, and wake up still
+	if (!_isAwake())
+	{
+		for (unsigned int i = 0; i < m_links.size(); i++)
+		{
+			m_links[i].velocity = 0;
+			m_links[i].jointForce = 0;
+		}
+
+		return;
+	}
+
+	unsigned int numLinks = m_links.size();
+
+	_updateFrames();
+	_updateVelocities();
+	_updateArticulatedInertias();
+
+	// The forces on each link, less the ones it needs to keep turning as it is
+	m_forces.resize(numLinks);
+	m_jointForces.resize(numLinks);
+
+	for (unsigned int i = 0; i < numLinks; i++)
+	{
+		Link &link = m_links[i];
+		m_jointForces[i] = link.jointForce;
+
+		if (i == 0 && isBaseFixed())
+		{
+			m_forces[i] = spatial(Vec3(0, 0, 0), Vec3(0, 0, 0));
+			continue;
+		}
+
+		const RigidBody &body = *link.body;
+		SpatialVector external = spatial(body._getTorqueAccum() + body.getPosition().cross(body._getForceAccum()), body._getForceAccum());
+		SpatialVector momentum = multiply(link.inertia, link.spatialVelocity);
+
+		m_forces[i] = spatialAdd(crossForce(link.spatialVelocity, momentum), spatialScale(external, -1));
+	}
+
+	SpatialVector baseAcceleration = _solve(true);
+
+	// Update the speeds
+	Scalar damping = scalar_pow(m_jointDamping, timeStep);
+
+	for (unsigned int i = 1; i < numLinks; i++)
+	{
+		m_links[i].velocity += m_jointAccelerations[i] * timeStep;
+		m_links[i].velocity *= damping;
+	}
+
+	SpatialVector baseVelocity = spatialAdd(m_links[0].spatialVelocity, spatialScale(baseAcceleration, timeStep));
+
+	_applyLimits(timeStep, baseVelocity);
+
+	// Then the positions
+	for (unsigned int i = 1; i < numLinks; i++)
+	{
+		m_links[i].position += m_links[i].velocity * timeStep;
+	}
+
+	_clampPositions();
+
+	if (!isBaseFixed())
+	{
+		RigidBody &base = *m_links[0].body;
+
+		// The base's centre moves during the update, which turns the velocity of the point at the origin
+		Vec3 velocity = baseVelocity.linear + baseVelocity.angular.cross(base.getPosition()) + base.getAngularVelocity().cross(base.getVelocity()) * timeStep;
+		Vec3 angularVelocity = baseVelocity.angular * scalar_pow(base.getAngularDamping(), timeStep);
+		velocity *= scalar_pow(base.getDamping(), timeStep);
+
+		base.setPositionAndAngle(base.getPosition() + velocity * timeStep, turn(base.getAngle(), angularVelocity, timeStep));
+		base.setVelocity(velocity);
+		base.setAngularVelocity(angularVelocity);
+	}
+
+	for (unsigned int i = 0; i < numLinks; i++)
+	{
+		if (m_links[i].body->getInvMass() != 0)
+		{
+			m_links[i].body->clearForces();
+		}
+
+		m_links[i].jointForce = 0;
+	}
+
+	_placeLinks();
+	_storeLinkStates();
+}
+
+void Articulation::applyLinkChanges(const Scalar &timeStep)
+{
+	if (!_isAwake()) { return; }
+
+	unsigned int numLinks = m_links.size();
+	bool isFixed = isBaseFixed();
+
+	// What the contact resolver did to each link, as the motion it added and the pseudo motion that pushed it
+	m_forces.resize(numLinks);
+	m_pushes.resize(numLinks);
+
+	for (unsigned int i = 0; i < numLinks; i++)
+	{
+		Link &link = m_links[i];
+
+		if (i == 0 && isFixed)
+		{
+			m_forces[i] = spatial(Vec3(0, 0, 0), Vec3(0, 0, 0));
+			m_pushes[i] = m_forces[i];
+			continue;
+		}
+
+		RigidBody &body = *link.body;
+
+		m_forces[i] = bodyMotion(body.getVelocity() - link.lastVelocity, body.getAngularVelocity() - link.lastAngularVelocity, link.lastPosition);
+		m_pushes[i] = bodyMotion((body.getPosition() - link.lastPosition) / timeStep, rotationBetween(link.lastAngle, body.getAngle()) / timeStep, link.lastPosition);
+
+		// Put the link back where the joints had it
+		body.setPositionAndAngle(link.lastPosition, link.lastAngle);
+	}
+
+	_updateFrames();
+	_updateArticulatedInertias();
+
+	// The impulses that made those changes to the free links, pushed through the articulation instead
+	m_jointForces.assign(numLinks, 0);
+
+	for (unsigned int i = 0; i < numLinks; i++)
+	{
+		m_forces[i] = spatialScale(multiply(m_links[i].inertia, m_forces[i]), -1);
+	}
+
+	SpatialVector baseChange = _solve(false);
+
+	for (unsigned int i = 1; i < numLinks; i++)
+	{
+		m_links[i].velocity += m_jointAccelerations[i];
+	}
+
+	// Same again with the pseudo impulses, moving the joints instead
+	for (unsigned int i = 0; i < numLinks; i++)
+	{
+		m_forces[i] = spatialScale(multiply(m_links[i].inertia, m_pushes[i]), -1);
+	}
+
+	SpatialVector basePush = _solve(false);
+
+	for (unsigned int i = 1; i < numLinks; i++)
+	{
+		m_links[i].position += m_jointAccelerations[i] * timeStep;
+	}
+
+	_clampPositions();
+
+	if (!isFixed)
+	{
+		Link &link = m_links[0];
+		RigidBody &base = *link.body;
+
+		SpatialVector baseVelocity = spatialAdd(bodyMotion(link.lastVelocity, link.lastAngularVelocity, link.lastPosition), baseChange);
+		Vec3 pushVelocity = basePush.linear + basePush.angular.cross(link.lastPosition);
+
+		base.setPositionAndAngle(link.lastPosition + pushVelocity * timeStep, turn(link.lastAngle, basePush.angular, timeStep));
+		base.setVelocity(baseVelocity.linear + baseVelocity.angular.cross(link.lastPosition));
+		base.setAngularVelocity(baseVelocity.angular);
+	}
+
+	_placeLinks();
+}
+
+void Articulation::applyJointForce(unsigned int link, const Scalar &force)
+{
+	m_links[link].jointForce += force;
+	m_links[link].body->setAwake(true);
+}
+
+void Articulation::setJointLimits(unsigned int link, const Scalar &lower, const Scalar &upper)
+{
+	Scalar scale = (m_links[link].type == JOINT_REVOLUTE) ? 1 / RAD_TO_DEG : 1;
+
+	m_links[link].lowerLimit = lower * scale;
+	m_links[link].upperLimit = upper * scale;
+	m_links[link].isLimited = true;
+}
+
+void Articulation::setJointPosition(unsigned int link, const Scalar &position)
+{
+	Scalar scale = (m_links[link].type == JOINT_REVOLUTE) ? 1 / RAD_TO_DEG : 1;
+
+	m_links[link].position = position * scale;
+	_placeLinks();
+	_storeLinkStates();
+}
+
+void Articulation::setJointVelocity(unsigned int link, const Scalar &velocity)
+{
+	m_links[link].velocity = velocity;
+	_placeLinks();
+	_storeLinkStates();
+}
+
+const Scalar Articulation::getJointPosition(unsigned int link) const
+{
+	Scalar scale = (m_links[link].type == JOINT_REVOLUTE) ? RAD_TO_DEG : 1;
+
+	return m_links[link].position * scale;
+}
+
+void Articulation::setIsJointLimited(unsigned int link, bool isLimited) { m_links[link].isLimited = isLimited; }
+void Articulation::setJointDamping(const Scalar &damping) { m_jointDamping = damping; }
+const Scalar& Articulation::getJointVelocity(unsigned int link) const { return m_links[link].velocity; }
+const Scalar& Articulation::getJointDamping() const { return m_jointDamping; }
+Articulation::JointType Articulation::getJointType(unsigned int link) const { return m_links[link].type; }
+bool Articulation::isJointLimited(unsigned int link) const { return m_links[link].isLimited; }
+unsigned int Articulation::getParent(unsigned int link) const { return m_links[link].parent; }
+unsigned int Articulation::getNumLinks() const { return m_links.size(); }
+RigidBody& Articulation::getLinkBody(unsigned int link) const { return *m_links[link].body; }
+bool Articulation::isBaseFixed() const { return m_links[0].body->getInvMass() == 0; }
+
+//--------------------------
+//	PRIVATES
+//--------------------------
+
+bool Articulation::_isAwake() const
+{
+	if (!isBaseFixed())
+	{
+		return m_links[0].body->isAwake();
+	}
+
+	// The links share an island, so they all sleep together
+	return m_links.size() > 1 && m_links[1].body->isAwake();
+}
+
+void Articulation::_updateFrames()
+{
+	for (unsigned int i = 1; i < m_links.size(); i++)
+	{
+		Link &link = m_links[i];
+		const RigidBody &parent = *m_links[link.parent].body;
+
+		Vec3 axis = rotate(parent.getAngle(), link.axisInParent);
+
+		if (link.type == JOINT_REVOLUTE)
+		{
+			Vec3 anchor = parent.getTransform() * link.anchorInParent;
+			link.motion = spatial(axis, anchor.cross(axis));
+		}
+		else
+		{
+			link.motion = spatial(Vec3(0, 0, 0), axis);
+		}
+	}
+}
+
+void Articulation::_updateVelocities()
+{
+	const RigidBody &base = *m_links[0].body;
+	m_links[0].spatialVelocity = bodyMotion(base.getVelocity(), base.getAngularVelocity(), base.getPosition());
+
+	for (unsigned int i = 1; i < m_links.size(); i++)
+	{
+		Link &link = m_links[i];
+		SpatialVector jointVelocity = spatialScale(link.motion, link.velocity);
+
+		link.spatialVelocity = spatialAdd(m_links[link.parent].spatialVelocity, jointVelocity);
+		link.bias = crossMotion(link.spatialVelocity, jointVelocity);
+	}
+}
+
+void Articulation::_updateArticulatedInertias()
+{
+	for (unsigned int i = 0; i < m_links.size(); i++)
+	{
+		Link &link = m_links[i];
+
+		if (link.body->getInvMass() != 0)
+		{
+			link.inertia = rigidInertia(*link.body);
+		}
+		else
+		{
+			setZero(link.inertia);
+		}
+
+		link.articulatedInertia = link.inertia;
+	}
+
+	// Children always come after their parent, so going backwards sees every link after all of its children
+	for (unsigned int i = m_links.size() - 1; i > 0; i--)
+	{
+		Link &link = m_links[i];
+		SpatialMatrix &parentInertia = m_links[link.parent].articulatedInertia;
+
+		link.U = multiply(link.articulatedInertia, link.motion);
+		link.D = spatialDot(link.motion, link.U);
+
+		Scalar U[6];
+		toArray(link.U, U);
+
+		// The parent feels the link's inertia, less the part the joint lets go
+		for (unsigned int row = 0; row < 6; row++)
+		{
+			for (unsigned int col = 0; col < 6; col++)
+			{
+				parentInertia.m[row][col] += link.articulatedInertia.m[row][col] - U[row] * U[col] / link.D;
+			}
+		}
+	}
+}
+
+const SpatialVector Articulation::_solve(bool isBiasIncluded)
+{
+	unsigned int numLinks = m_links.size();
+	m_jointAccelerations.assign(numLinks, 0);
+
+	// Pass each link's force in to its parent, less what the joint takes
+	for (unsigned int i = numLinks - 1; i > 0; i--)
+	{
+		Link &link = m_links[i];
+
+		link.u = m_jointForces[i] - spatialDot(link.motion, m_forces[i]);
+
+		SpatialVector passed = spatialAdd(m_forces[i], spatialScale(link.U, link.u / link.D));
+
+		if (isBiasIncluded)
+		{
+			passed = spatialAdd(passed, multiply(link.articulatedInertia, link.bias));
+			passed = spatialAdd(passed, spatialScale(link.U, -spatialDot(link.U, link.bias) / link.D));
+		}
+
+		m_forces[link.parent] = spatialAdd(m_forces[link.parent], passed);
+	}
+
+	// The forces are passed on, so their storage holds the links' accelerations on the way back out
+	SpatialVector baseAcceleration = spatial(Vec3(0, 0, 0), Vec3(0, 0, 0));
+
+	if (!isBaseFixed())
+	{
+		baseAcceleration = spatialScale(solveSpatial(m_links[0].articulatedInertia, m_forces[0]), -1);
+	}
+
+	m_forces[0] = baseAcceleration;
+
+	for (unsigned int i = 1; i < numLinks; i++)
+	{
+		Link &link = m_links[i];
+
+		SpatialVector acceleration = m_forces[link.parent];
+
+		if (isBiasIncluded)
+		{
+			acceleration = spatialAdd(acceleration, link.bias);
+		}
+
+		m_jointAccelerations[i] = (link.u - spatialDot(link.U, acceleration)) / link.D;
+		m_forces[i] = spatialAdd(acceleration, spatialScale(link.motion, m_jointAccelerations[i]));
+	}
+
+	return baseAcceleration;
+}
+
+void Articulation::_applyLimits(const Scalar &timeStep, SpatialVector &baseVelocity)
+{
+	unsigned int numLinks = m_links.size();
+
+	for (unsigned int i = 1; i < numLinks; i++)
+	{
+		Link &link = m_links[i];
+
+		if (!link.isLimited) { continue; }
+
+		// Only stop joints that would pass their limit this update, right on the limit
+		Scalar next = link.position + link.velocity * timeStep;
+		Scalar targetVelocity;
+
+		if (next < link.lowerLimit)
+		{
+			targetVelocity = (link.lowerLimit - link.position) / timeStep;
+		}
+		else if (next > link.upperLimit)
+		{
+			targetVelocity = (link.upperLimit - link.position) / timeStep;
+		}
+		else
+		{
+			continue;
+		}
+
+		// How the whole tree answers a unit impulse on the joint
+		m_forces.assign(numLinks, spatial(Vec3(0, 0, 0), Vec3(0, 0, 0)));
+		m_jointForces.assign(numLinks, 0);
+		m_jointForces[i] = 1;
+
+		SpatialVector baseResponse = _solve(false);
+		Scalar impulse = (targetVelocity - link.velocity) / m_jointAccelerations[i];
+
+		for (unsigned int j = 1; j < numLinks; j++)
+		{
+			m_links[j].velocity += m_jointAccelerations[j] * impulse;
+		}
+
+		if (!isBaseFixed())
+		{
+			baseVelocity = spatialAdd(baseVelocity, spatialScale(baseResponse, impulse));
+		}
+	}
+}
+
+void Articulation::_clampPositions()
+{
+	for (unsigned int i = 1; i < m_links.size(); i++)
+	{
+		Link &link = m_links[i];
+
+		if (!link.isLimited) { continue; }
+
+		link.position = (link.position < link.lowerLimit) ? link.lowerLimit : link.position;
+		link.position = (link.position > link.upperLimit) ? link.upperLimit : link.position;
+	}
+}
+
+void Articulation::_placeLinks()
+{
+	// Place each link from its parent and its joint's position
+	for (unsigned int i = 1; i < m_links.size(); i++)
+	{
+		Link &link = m_links[i];
+		const RigidBody &parent = *m_links[link.parent].body;
+
+		Vec3 anchor = parent.getTransform() * link.anchorInParent;
+		Quat angle;
+
+		if (link.type == JOINT_REVOLUTE)
+		{
+			angle = parent.getAngle() * Quat(link.axisInParent, link.position * RAD_TO_DEG) * link.restAngle;
+		}
+		else
+		{
+			angle = parent.getAngle() * link.restAngle;
+			anchor = anchor + rotate(parent.getAngle(), link.axisInParent) * link.position;
+		}
+
+		angle.normalize();
+
+		link.body->setPositionAndAngle(anchor - rotate(angle, link.anchorInBody), angle);
+	}
+
+	// Then give each link the velocity the joints give it
+	_updateFrames();
+	_updateVelocities();
+
+	for (unsigned int i = 1; i < m_links.size(); i++)
+	{
+		Link &link = m_links[i];
+		RigidBody &body = *link.body;
+
+		body.setVelocity(link.spatialVelocity.linear + link.spatialVelocity.angular.cross(body.getPosition()));
+		body.setAngularVelocity(link.spatialVelocity.angular);
+	}
+}
+
+void Articulation::_storeLinkStates()
+{
+	for (unsigned int i = 0; i < m_links.size(); i++)
+	{
+		Link &link = m_links[i];
+		const RigidBody &body = *link.body;
+
+		link.lastVelocity = body.getVelocity();
+		link.lastAngularVelocity = body.getAngularVelocity();
+		link.lastPosition = body.getPosition();
+		link.lastAngle = body.getAngle();
+	}
+}
+
+} // namespace lt
@@ -0,0 +1,220 @@
+#ifndef LTPHYS_ARTICULATION_HPP
+#define LTPHYS_ARTICULATION_HPP
+
+#include <vector>
+
+#include "../lt3DMath/lt3DMath.hpp"
+
+#include "RigidBody.hpp"
+
+namespace lt
+{
+
+////////////////////////////////////////////////////////////
+///	@brief A tree of rigid bodies held together by joints
+/// that are solved exactly, like a ragdoll or a robot arm.
+///
+/// Each link is joined to its parent by a one degree of
+/// freedom joint, a revolute joint that turns about an axis
+/// or a prismatic joint that slides along one. A ball joint
+/// is three revolute joints about different axes, through
+/// links with a small mass. The tree's root is the base
+/// body, a static base is fixed in place, a dynamic base
+/// floats freely.
+///
+/// The articulation keeps the joints' positions and speeds
+/// instead of each link's, and moves them with Featherstone's
+/// articulated body algorithm, which takes time linear in the
+/// number of links. The links are then placed from the
+/// joints, so they can't drift apart however long the update.
+/// Forces on the link bodies, like gravity, act on the whole
+/// articulation.
+///
+/// The link bodies are added to the world as usual and
+/// collide like any other body. The contact resolver treats
+/// them as free bodies, the changes it makes to their
+/// velocities and positions are then taken back into the
+/// joints as impulses on the links. Links don't collide with
+/// their parent. Articulations are registered through the
+/// World class and connect their links' islands.
+///
+/// @author Leon Turpin
+/// @date November 2014
+////////////////////////////////////////////////////////////
+class Articulation
+{
+public:
+	enum JointType
+	{
+		JOINT_REVOLUTE = 0,
+		JOINT_PRISMATIC = 1
+	};
+
+	////////////////////////////////////////////////////////////
+	/// A motion or force in world space, measured at the world
+	/// origin. A motion is an angular velocity and the velocity
+	/// of the point of the body at the origin, a force is a
+	/// force's moment about the origin and the force itself.
+	////////////////////////////////////////////////////////////
+	struct SpatialVector
+	{
+		Vec3 angular;
+		Vec3 linear;
+	};
+
+	struct SpatialMatrix
+	{
+		Scalar m[6][6];
+	};
+
+	////////////////////////////////////////////////////////////
+	/// @brief Constructor
+	///
+	/// @param base The root of the tree, link 0. A static body
+	/// gives a fixed base, a dynamic one a floating base.
+	///
+	////////////////////////////////////////////////////////////
+	Articulation(RigidBody &base);
+
+	////////////////////////////////////////////////////////////
+	/// @brief Add a link to the tree.
+	///
+	/// The anchor and axis are given in world space at the
+	/// bodies' current positions, where the joint's position
+	/// is 0. Revolute joints turn body about the axis through
+	/// the anchor, prismatic joints slide it along the axis.
+	///
+	/// @param parent Index of the link to join body to.
+	/// @param body The link's body, it should be dynamic.
+	/// @param type The type of joint.
+	/// @param anchor The joint's position.
+	/// @param axis The joint's axis.
+	///
+	/// @return The index of the new link.
+	///
+	////////////////////////////////////////////////////////////
+	unsigned int addLink(unsigned int parent, RigidBody &body, JointType type, const Vec3 &anchor, const Vec3 &axis);
+
+	////////////////////////////////////////////////////////////
+	/// @brief Called by the world each update, instead of
+	/// integrating the link bodies. Moves the joints under the
+	/// forces on the links and the joints, then places the
+	/// links.
+	///
+	/// @param timeStep The length of the update.
+	///
+	////////////////////////////////////////////////////////////
+	void integrate(const Scalar &timeStep);
+
+	////////////////////////////////////////////////////////////
+	/// @brief Called by the world after the contacts are
+	/// resolved. Takes the changes the contact resolver made to
+	/// the links' velocities and positions back into the joints
+	/// through the articulation, then places the links again.
+	///
+	/// @param timeStep The length of the update.
+	///
+	////////////////////////////////////////////////////////////
+	void applyLinkChanges(const Scalar &timeStep);
+
+	////////////////////////////////////////////////////////////
+	/// @brief Apply a torque to a revolute joint, or a force to
+	/// a prismatic one, for the next update.
+	////////////////////////////////////////////////////////////
+	void applyJointForce(unsigned int link, const Scalar &force);
+
+	////////////////////////////////////////////////////////////
+	/// @brief Keep a joint's position between lower and upper,
+	/// in degrees for revolute joints.
+	////////////////////////////////////////////////////////////
+	void setJointLimits(unsigned int link, const Scalar &lower, const Scalar &upper);
+
+	void setIsJointLimited(unsigned int link, bool isLimited);
+
+	////////////////////////////////////////////////////////////
+	/// @brief Set a joint's position, in degrees for revolute
+	/// joints. The links are placed again straight away.
+	////////////////////////////////////////////////////////////
+	void setJointPosition(unsigned int link, const Scalar &position);
+
+	////////////////////////////////////////////////////////////
+	/// @brief Set a joint's speed, in radians per second for
+	/// revolute joints.
+	////////////////////////////////////////////////////////////
+	void setJointVelocity(unsigned int link, const Scalar &velocity);
+
+	////////////////////////////////////////////////////////////
+	/// @brief Set how much of the joints' speeds is kept each
+	/// second, like a body's damping.
+	////////////////////////////////////////////////////////////
+	void setJointDamping(const Scalar &damping);
+
+	const Scalar getJointPosition(unsigned int link) const;
+	const Scalar& getJointVelocity(unsigned int link) const;
+	const Scalar& getJointDamping() const;
+	JointType getJointType(unsigned int link) const;
+	bool isJointLimited(unsigned int link) const;
+	unsigned int getParent(unsigned int link) const;
+	unsigned int getNumLinks() const;
+	RigidBody& getLinkBody(unsigned int link) const;
+	bool isBaseFixed() const;
+
+private:
+	struct Link
+	{
+		RigidBody *body;
+		unsigned int parent;
+		JointType type;
+
+		Vec3 anchorInParent; // The joint's anchor in the parent's body space
+		Vec3 anchorInBody; // The joint's anchor in the link's body space
+		Vec3 axisInParent; // The joint's axis in the parent's body space
+		Quat restAngle; // The link's angle relative to its parent when the joint's position is 0
+
+		Scalar position; // Radians for revolute joints
+		Scalar velocity;
+		Scalar jointForce; // Applied through applyJointForce, cleared each update
+
+		bool isLimited;
+		Scalar lowerLimit;
+		Scalar upperLimit;
+
+		SpatialVector motion; // The link's motion for a unit joint speed
+		SpatialVector spatialVelocity;
+		SpatialVector bias; // Acceleration from the joint turning while its parent moves
+		SpatialVector U; // Articulated inertia times motion
+		SpatialMatrix inertia; // The link body's own spatial inertia
+		SpatialMatrix articulatedInertia; // Inertia of the link and everything past it, as felt through the joint
+		Scalar D; // Motion dotted with U
+		Scalar u; // Joint force left over after the forces from past the joint
+
+		// The body's state after integration, for spotting the contact resolver's changes
+		Vec3 lastVelocity;
+		Vec3 lastAngularVelocity;
+		Vec3 lastPosition;
+		Quat lastAngle;
+	};
+
+	std::vector<Link> m_links;
+	Scalar m_jointDamping;
+
+	// Scratch space for _solve
+	std::vector<SpatialVector> m_forces;
+	std::vector<Scalar> m_jointForces;
+	std::vector<Scalar> m_jointAccelerations;
+	std::vector<SpatialVector> m_pushes;
+
+	bool _isAwake() const;
+	void _updateFrames();
+	void _updateVelocities();
+	void _updateArticulatedInertias();
+	const SpatialVector _solve(bool isBiasIncluded);
+	void _applyLimits(const Scalar &timeStep, SpatialVector &baseVelocity);
+	void _clampPositions();
+	void _placeLinks();
+	void _storeLinkStates();
+};
+
+} // namespace lt
+
+#endif // LTPHYS_ARTICULATION_HPP
@@ -0,0 +1,515 @@
+#include "BodyStorage.hpp"
+
+#include <math.h>
+
+namespace lt
+{
+
+BodyStorage::BodyStorage()
+{
+	m_numBodies = 0;
+	m_dampingTimeStep = 0;
+}
+
+unsigned int BodyStorage::addBody()
+{
+	// Grow a whole SIMD register at a time
+	if (m_numBodies == m_invMass.size())
+	{
+		_grow(m_position);
+		_grow(m_velocity);
+		_grow(m_angle);
+		_grow(m_angularVelocity);
+		_grow(m_force);
+		_grow(m_torque);
+		m_invMass.resize(m_invMass.size() + SIMD_LANES, 0);
+		_grow(m_invInertiaTensor);
+		m_isIntegrated.resize(m_isIntegrated.size() + SIMD_LANES, 0);
+		m_linearDampingFactor.resize(m_linearDampingFactor.size() + SIMD_LANES, 0);
+		m_angularDampingFactor.resize(m_angularDampingFactor.size() + SIMD_LANES, 0);
+		m_damping.resize(m_damping.size() + SIMD_LANES, 0);
+		m_angularDamping.resize(m_angularDamping.size() + SIMD_LANES, 0);
+		_grow(m_previousPosition);
+		_grow(m_previousAngle);
+
+		m_transform.resize(m_transform.size() + SIMD_LANES, Transform());
+		m_invInertiaTensorWorld.resize(m_invInertiaTensorWorld.size() + SIMD_LANES, Mat3());
+		m_isDerivedDataDirty.resize(m_isDerivedDataDirty.size() + SIMD_LANES, 0);
+	}
+
+	return m_numBodies++;
+}
+
+void BodyStorage::removeBody(unsigned int index)
+{
+	unsigned int last = m_numBodies - 1;
+
+	_moveLast(m_position, index, last);
+	_moveLast(m_velocity, index, last);
+	_moveLast(m_angle, index, last);
+	_moveLast(m_angularVelocity, index, last);
+	_moveLast(m_force, index, last);
+	_moveLast(m_torque, index, last);
+	_moveLast(m_invInertiaTensor, index, last);
+	_moveLast(m_previousPosition, index, last);
+	_moveLast(m_previousAngle, index, last);
+
+	// Leave the emptied slot as padding, never integrated
+	ScalarArray* singles[] = { &m_invMass, &m_isIntegrated, &m_linearDampingFactor, &m_angularDampingFactor, &m_damping, &m_angularDamping };
+
+	for (unsigned int i = 0; i < sizeof(singles) / sizeof(singles[0]); i++)
+	{
+		(*singles[i])[index] = (*singles[i])[last];
+		(*singles[i])[last] = 0;
+	}
+
+	m_transform[index] = m_transform[last];
+	m_transform[last] = Transform();
+
+	m_invInertiaTensorWorld[index] = m_invInertiaTensorWorld[last];
+	m_invInertiaTensorWorld[last] = Mat3();
+
+	m_isDerivedDataDirty[index] = m_isDerivedDataDirty[last];
+	m_isDerivedDataDirty[last] = 0;
+
+	m_numBodies--;
+}
+
+unsigned int BodyStorage::getNumBodies() const
+{
+	return m_numBodies;
+}
+
+void BodyStorage::integrate(const Scalar &timeStep, IntegratorType integrator, bool isGyroscopicTorqueEnabled)
+{
+	if (timeStep != m_dampingTimeStep)
+	{
+		_setDampingTimeStep(timeStep);
+	}
+
+	for (unsigned int first = 0; first < m_numBodies; first += SIMD_LANES)
+	{
+		_integrateLanes(first, timeStep, integrator, isGyroscopicTorqueEnabled);
+	}
+}
+
+void BodyStorage::calcDerivedData(unsigned int index) const
+{
+	m_isDerivedDataDirty[index] = 0;
+
+	// Calculate the transformation matrix
+	m_transform[index] = Transform(getPosition(index), getAngle(index));
+
+	// Calculate the inverse inertia tensor in world space.
+	_transformInertiaTensor(m_invInertiaTensorWorld[index], getInvInertiaTensor(index), m_transform[index]);
+}
+
+void BodyStorage::updateDerivedData()
+{
+	for (unsigned int i = 0; i < m_numBodies; i++)
+	{
+		if (m_isDerivedDataDirty[i]) { calcDerivedData(i); }
+	}
+}
+
+void BodyStorage::setIsIntegrated(unsigned int index, bool isIntegrated)
+{
+	m_isIntegrated[index] = isIntegrated ? 1.0f : 0.0f;
+}
+
+void BodyStorage::setDamping(unsigned int index, const Scalar &damping, const Scalar &angularDamping)
+{
+	m_damping[index] = damping;
+	m_angularDamping[index] = angularDamping;
+	m_linearDampingFactor[index] = scalar_pow(damping, m_dampingTimeStep);
+	m_angularDampingFactor[index] = scalar_pow(angularDamping, m_dampingTimeStep);
+}
+
+void BodyStorage::storePreviousStates()
+{
+	for (unsigned int i = 0; i < 3; i++)
+	{
+		m_previousPosition[i] = m_position[i];
+	}
+
+	for (unsigned int i = 0; i < 4; i++)
+	{
+		m_previousAngle[i] = m_angle[i];
+	}
+}
+
+void BodyStorage::resetPreviousState(unsigned int index)
+{
+	for (unsigned int i = 0; i < 3; i++)
+	{
+		m_previousPosition[i][index] = m_position[i][index];
+	}
+
+	for (unsigned int i = 0; i < 4; i++)
+	{
+		m_previousAngle[i][index] = m_angle[i][index];
+	}
+}
+
+const Transform BodyStorage::getInterpolatedTransform(unsigned int index, const Scalar &alpha) const
+{
+	Scalar position[3], angle[4];
+
+	for (unsigned int i = 0; i < 3; i++)
+	{
+		position[i] = m_previousPosition[i][index] + (m_position[i][index] - m_previousPosition[i][index]) * alpha;
+	}
+
+	// q and -q are the same angle, blend towards whichever is nearer
+	Scalar dot = 0;
+
+	for (unsigned int i = 0; i < 4; i++)
+	{
+		dot += m_previousAngle[i][index] * m_angle[i][index];
+	}
+
+	Scalar sign = (dot < 0) ? -1.0f : 1.0f;
+
+	for (unsigned int i = 0; i < 4; i++)
+	{
+		angle[i] = m_previousAngle[i][index] + (m_angle[i][index] * sign - m_previousAngle[i][index]) * alpha;
+	}
+
+	Quat blended(angle[0], angle[1], angle[2], angle[3]);
+	blended.normalize();
+
+	return Transform(Vec3(position[0], position[1], position[2]), blended);
+}
+
+//--------------------------
+//	PRIVATES
+//--------------------------
+
+void BodyStorage::_integrateLanes(unsigned int first, const Scalar &timeStep, IntegratorType integrator, bool isGyroscopicTorqueEnabled)
+{
+	bool isAnyIntegrated = false;
+
+	for (unsigned int i = first; i < first + SIMD_LANES; i++)
+	{
+		isAnyIntegrated = isAnyIntegrated || (m_isIntegrated[i] != 0);
+	}
+
+	// Whole registers of sleeping or static bodies are common
+	if (!isAnyIntegrated) { return; }
+
+	const SimdFloat dt(timeStep);
+	const SimdFloat zero(0.0f);
+	const SimdFloat mask = simdGreater(SimdFloat::load(&m_isIntegrated[first]), zero);
+	const SimdFloat invMass = SimdFloat::load(&m_invMass[first]);
+	const SimdFloat linearDamping = SimdFloat::load(&m_linearDampingFactor[first]);
+	const SimdFloat angularDamping = SimdFloat::load(&m_angularDampingFactor[first]);
+
+	SimdFloat force[3], torque[3], invInertia[9], invInertiaWorld[9];
+
+	for (unsigned int i = 0; i < 3; i++)
+	{
+		force[i] = SimdFloat::load(&m_force[i][first]);
+		torque[i] = SimdFloat::load(&m_torque[i][first]);
+	}
+
+	for (unsigned int i = 0; i < 9; i++)
+	{
+		invInertia[i] = SimdFloat::load(&m_invInertiaTensor[i][first]);
+	}
+
+	// Torques are in world space, gather the world tensors, bodies set since the last update catch up here
+	Scalar lanes[9][SIMD_LANES];
+
+	for (unsigned int lane = 0; lane < SIMD_LANES; lane++)
+	{
+		const Mat3 &tensor = getInvInertiaTensorWorld(first + lane);
+
+		for (unsigned int i = 0; i < 9; i++)
+		{
+			lanes[i][lane] = tensor.get(i);
+		}
+	}
+
+	for (unsigned int i = 0; i < 9; i++)
+	{
+		invInertiaWorld[i] = SimdFloat::load(lanes[i]);
+	}
+
+	for (unsigned int i = 0; i < 3; i++)
+	{
+		// Acceleration due to force, and angular acceleration due to torque
+		SimdFloat accel = force[i] * invMass;
+		SimdFloat angAccel = torque[0] * invInertiaWorld[i * 3 + 0] + torque[1] * invInertiaWorld[i * 3 + 1] + torque[2] * invInertiaWorld[i * 3 + 2];
+
+		SimdFloat vel = SimdFloat::load(&m_velocity[i][first]);
+		SimdFloat angVel = SimdFloat::load(&m_angularVelocity[i][first]);
+		SimdFloat pos = SimdFloat::load(&m_position[i][first]);
+
+		// Update velocities, apply damping and update the position
+		SimdFloat newVel = (vel + accel * dt) * linearDamping;
+		SimdFloat newAngVel = (angVel + angAccel * dt) * angularDamping;
+		SimdFloat newPos = pos + newVel * dt;
+
+		simdSelect(mask, newVel, vel).store(&m_velocity[i][first]);
+		simdSelect(mask, newAngVel, angVel).store(&m_angularVelocity[i][first]);
+		simdSelect(mask, newPos, pos).store(&m_position[i][first]);
+
+		// Clear accumulators
+		simdSelect(mask, zero, force[i]).store(&m_force[i][first]);
+		simdSelect(mask, zero, torque[i]).store(&m_torque[i][first]);
+	}
+
+	// Static bodies don't spin, so only dynamic ones need their wobble
+	if (isGyroscopicTorqueEnabled)
+	{
+		for (unsigned int i = first; i < first + SIMD_LANES; i++)
+		{
+			if (m_isIntegrated[i] == 0 || m_invMass[i] == 0) { continue; }
+
+			_set(m_angularVelocity, i, _solveGyroscopic(getAngularVelocity(i), getInvInertiaTensor(i), getTransform(i), timeStep));
+		}
+	}
+
+	if (integrator == INTEGRATOR_EULER)
+	{
+		// angle += timeStep/2 * angularVelocity * angle, then normalize
+		const SimdFloat halfDt(timeStep * 0.5f);
+		SimdFloat qx = SimdFloat::load(&m_angle[0][first]);
+		SimdFloat qy = SimdFloat::load(&m_angle[1][first]);
+		SimdFloat qz = SimdFloat::load(&m_angle[2][first]);
+		SimdFloat qw = SimdFloat::load(&m_angle[3][first]);
+		SimdFloat wx = SimdFloat::load(&m_angularVelocity[0][first]);
+		SimdFloat wy = SimdFloat::load(&m_angularVelocity[1][first]);
+		SimdFloat wz = SimdFloat::load(&m_angularVelocity[2][first]);
+
+		SimdFloat nx = qx + halfDt * (wx * qw + wy * qz - wz * qy);
+		SimdFloat ny = qy + halfDt * (wy * qw + wz * qx - wx * qz);
+		SimdFloat nz = qz + halfDt * (wz * qw + wx * qy - wy * qx);
+		SimdFloat nw = qw - halfDt * (wx * qx + wy * qy + wz * qz);
+
+		SimdFloat length = simdSqrt(nx * nx + ny * ny + nz * nz + nw * nw);
+
+		// Padding lanes have a zero angle, keep them clear of the divide
+		length = simdSelect(mask, length, SimdFloat(1.0f));
+
+		simdSelect(mask, nx / length, qx).store(&m_angle[0][first]);
+		simdSelect(mask, ny / length, qy).store(&m_angle[1][first]);
+		simdSelect(mask, nz / length, qz).store(&m_angle[2][first]);
+		simdSelect(mask, nw / length, qw).store(&m_angle[3][first]);
+	}
+	else
+	{
+		// A sin and cos per body, one body at a time
+		for (unsigned int i = first; i < first + SIMD_LANES; i++)
+		{
+			if (m_isIntegrated[i] == 0) { continue; }
+
+			setAngle(i, _integrateAngle(getAngle(i), getAngularVelocity(i), timeStep, integrator));
+		}
+	}
+
+	// Rotation matrix from the angle, as Transform(position, angle) builds it
+	const SimdFloat one(1.0f);
+	const SimdFloat two(2.0f);
+	SimdFloat x = SimdFloat::load(&m_angle[0][first]);
+	SimdFloat y = SimdFloat::load(&m_angle[1][first]);
+	SimdFloat z = SimdFloat::load(&m_angle[2][first]);
+	SimdFloat w = SimdFloat::load(&m_angle[3][first]);
+	SimdFloat sqX = x * x, sqY = y * y, sqZ = z * z;
+
+	// Row major, rot[0..2] is the transform's first row
+	SimdFloat rot[9];
+	rot[0] = one - two * sqY - two * sqZ;
+	rot[3] = two * x * y + two * z * w;
+	rot[6] = two * x * z - two * y * w;
+
+	rot[1] = two * x * y - two * z * w;
+	rot[4] = one - two * sqX - two * sqZ;
+	rot[7] = two * y * z + two * x * w;
+
+	rot[2] = two * x * z + two * y * w;
+	rot[5] = two * y * z - two * x * w;
+	rot[8] = one - two * sqX - two * sqY;
+
+	// Inverse inertia tensor in world space, the same sums as _transformInertiaTensor
+	SimdFloat t[9], iitWorld[9];
+
+	for (unsigned int r = 0; r < 3; r++)
+	{
+		for (unsigned int c = 0; c < 3; c++)
+		{
+			t[r * 3 + c] = rot[r * 3 + 0] * invInertia[c] + rot[r * 3 + 1] * invInertia[3 + c] + rot[r * 3 + 2] * invInertia[6 + c];
+		}
+	}
+
+	for (unsigned int r = 0; r < 3; r++)
+	{
+		for (unsigned int c = 0; c < 3; c++)
+		{
+			iitWorld[r * 3 + c] = t[r * 3 + 0] * rot[c * 3 + 0] + t[r * 3 + 1] * rot[c * 3 + 1] + t[r * 3 + 2] * rot[c * 3 + 2];
+		}
+	}
+
+	// Spread the lanes back out into each body's matrices
+	Scalar rotLanes[9][SIMD_LANES], iitLanes[9][SIMD_LANES];
+
+	for (unsigned int i = 0; i < 9; i++)
+	{
+		rot[i].store(rotLanes[i]);
+		iitWorld[i].store(iitLanes[i]);
+	}
+
+	for (unsigned int lane = 0; lane < SIMD_LANES; lane++)
+	{
+		unsigned int i = first + lane;
+
+		if (m_isIntegrated[i] == 0) { continue; }
+
+		Transform &transform = m_transform[i];
+		Mat3 &invInertiaWorld = m_invInertiaTensorWorld[i];
+
+		for (unsigned int r = 0; r < 3; r++)
+		{
+			for (unsigned int c = 0; c < 3; c++)
+			{
+				transform[r * 4 + c] = rotLanes[r * 3 + c][lane];
+			}
+
+			transform[r * 4 + 3] = m_position[r][i];
+		}
+
+		for (unsigned int j = 0; j < 9; j++)
+		{
+			invInertiaWorld[j] = iitLanes[j][lane];
+		}
+
+		m_isDerivedDataDirty[i] = 0;
+	}
+}
+
+void BodyStorage::_setDampingTimeStep(const Scalar &timeStep)
+{
+	m_dampingTimeStep = timeStep;
+
+	for (unsigned int i = 0; i < m_numBodies; i++)
+	{
+		m_linearDampingFactor[i] = scalar_pow(m_damping[i], timeStep);
+		m_angularDampingFactor[i] = scalar_pow(m_angularDamping[i], timeStep);
+	}
+}
+
+template <unsigned int N>
+void BodyStorage::_grow(ScalarArray (&arrays)[N])
+{
+	for (unsigned int i = 0; i < N; i++)
+	{
+		arrays[i].resize(arrays[i].size() + SIMD_LANES, 0);
+	}
+}
+
+template <unsigned int N>
+void BodyStorage::_moveLast(ScalarArray (&arrays)[N], unsigned int index, unsigned int last)
+{
+	for (unsigned int i = 0; i < N; i++)
+	{
+		arrays[i][index] = arrays[i][last];
+		arrays[i][last] = 0;
+	}
+}
+
+//--------------------------
+//	HELPERS
+//--------------------------
+
+void _transformInertiaTensor(Mat3 &iitWorld, const Mat3 &iitBody, const Transform &rotMat)
+{
+	// Note that the implementation of this function was created by an automated code generator and optimizer.
+	Scalar t4  = rotMat.get(0) * iitBody.get(0) + rotMat.get(1) * iitBody.get(3) + rotMat.get(2) * iitBody.get(6);
+	Scalar t9  = rotMat.get(0) * iitBody.get(1) + rotMat.get(1) * iitBody.get(4) + rotMat.get(2) * iitBody.get(7);
+	Scalar t14 = rotMat.get(0) * iitBody.get(2) + rotMat.get(1) * iitBody.get(5) + rotMat.get(2) * iitBody.get(8);
+
+	Scalar t28 = rotMat.get(4) * iitBody.get(0) + rotMat.get(5) * iitBody.get(3) + rotMat.get(6) * iitBody.get(6);
+	Scalar t33 = rotMat.get(4) * iitBody.get(1) + rotMat.get(5) * iitBody.get(4) + rotMat.get(6) * iitBody.get(7);
+	Scalar t38 = rotMat.get(4) * iitBody.get(2) + rotMat.get(5) * iitBody.get(5) + rotMat.get(6) * iitBody.get(8);
+
+	Scalar t52 = rotMat.get(8) * iitBody.get(0) + rotMat.get(9) * iitBody.get(3) + rotMat.get(10) * iitBody.get(6);
+	Scalar t57 = rotMat.get(8) * iitBody.get(1) + rotMat.get(9) * iitBody.get(4) + rotMat.get(10) * iitBody.get(7);
+	Scalar t62 = rotMat.get(8) * iitBody.get(2) + rotMat.get(9) * iitBody.get(5) + rotMat.get(10) * iitBody.get(8);
+
+	iitWorld[0] = t4 *rotMat.get(0) + t9 *rotMat.get(1) + t14*rotMat.get(2);
+	iitWorld[1] = t4 *rotMat.get(4) + t9 *rotMat.get(5) + t14*rotMat.get(6);
+	iitWorld[2] = t4 *rotMat.get(8) + t9 *rotMat.get(9) + t14*rotMat.get(10);
+
+	iitWorld[3] = t28*rotMat.get(0) + t33*rotMat.get(1) + t38*rotMat.get(2);
+	iitWorld[4] = t28*rotMat.get(4) + t33*rotMat.get(5) + t38*rotMat.get(6);
+	iitWorld[5] = t28*rotMat.get(8) + t33*rotMat.get(9) + t38*rotMat.get(10);
+
+	iitWorld[6] = t52*rotMat.get(0) + t57*rotMat.get(1) + t62*rotMat.get(2);
+	iitWorld[7] = t52*rotMat.get(4) + t57*rotMat.get(5) + t62*rotMat.get(6);
+	iitWorld[8] = t52*rotMat.get(8) + t57*rotMat.get(9) + t62*rotMat.get(10);
+}
+
+const Quat _integrateAngle(const Quat &angle, const Vec3 &angularVelocity, const Scalar &timeStep, IntegratorType integrator)
+{
+	Scalar speed = angularVelocity.length();
+	Quat turn;
+
+	if (integrator == INTEGRATOR_EXPONENTIAL_MAP && speed * timeStep > 0.0001f)
+	{
+		// Rotation about the angular velocity by its length times the timestep
+		Scalar halfAngle = speed * timeStep * 0.5f;
+		Scalar s = sinf(halfAngle) / speed;
+
+		turn = Quat(angularVelocity.x * s, angularVelocity.y * s, angularVelocity.z * s, cosf(halfAngle));
+		turn = turn * angle;
+	}
+	else
+	{
+		// First order, angle += timeStep/2 * angularVelocity * angle
+		Scalar h = timeStep * 0.5f;
+		const Vec3 &w = angularVelocity;
+
+		turn = Quat(
+			angle.x + h * (w.x * angle.w + w.y * angle.z - w.z * angle.y),
+			angle.y + h * (w.y * angle.w + w.z * angle.x - w.x * angle.z),
+			angle.z + h * (w.z * angle.w + w.x * angle.y - w.y * angle.x),
+			angle.w - h * (w.x * angle.x + w.y * angle.y + w.z * angle.z));
+	}
+
+	return turn.normalize();
+}
+
+const Vec3 _solveGyroscopic(const Vec3 &angularVelocity, const Mat3 &invInertiaTensor, const Transform &transform, const Scalar &timeStep)
+{
+	// Body space angular velocity and inertia
+	Vec3 w = transform.transformInvV(angularVelocity);
+	Mat3 inertia = invInertiaTensor.inverse();
+	Vec3 momentum = inertia * w;
+
+	// How far the angular momentum is from being kept over the step
+	Vec3 f = w.cross(momentum) * timeStep;
+
+	// Its jacobian, inertia + timeStep * (skew(w) * inertia - skew(momentum))
+	Scalar skewW[9] = { 0, -w.z, w.y, w.z, 0, -w.x, -w.y, w.x, 0 };
+	Mat3 skewWI = Mat3(skewW) * inertia;
+	Scalar j[9] = {
+		inertia.get(0) + timeStep * skewWI.get(0),
+		inertia.get(1) + timeStep * (skewWI.get(1) + momentum.z),
+		inertia.get(2) + timeStep * (skewWI.get(2) - momentum.y),
+		inertia.get(3) + timeStep * (skewWI.get(3) - momentum.z),
+		inertia.get(4) + timeStep * skewWI.get(4),
+		inertia.get(5) + timeStep * (skewWI.get(5) + momentum.x),
+		inertia.get(6) + timeStep * (skewWI.get(6) + momentum.y),
+		inertia.get(7) + timeStep * (skewWI.get(7) - momentum.x),
+		inertia.get(8) + timeStep * skewWI.get(8) };
+
+	// One Newton step
+	w = w - Mat3(j).inverse() * f;
+
+	Vec3 direction = w;
+	direction.w = 0;
+
+	return transform * direction;
+}
+
+} // namespace lt
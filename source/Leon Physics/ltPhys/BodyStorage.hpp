@@ -0,0 +1,314 @@
+#ifndef LTPHYS_BODYSTORAGE_HPP
+#define LTPHYS_BODYSTORAGE_HPP
+
+#include <vector>
+
+#include "../lt3DMath/lt3DMath.hpp"
+
+#include "AlignedAllocator.hpp"
+#include "SimdFloat.hpp"
+
+namespace lt
+{
+
+typedef std::vector<Scalar, AlignedAllocator<Scalar> > ScalarArray;
+
+////////////////////////////////////////////////////////////
+/// @brief How bodies' angles are moved by their angular
+/// velocities each update.
+///
+/// Both update the velocities first and move the bodies
+/// with the new ones, semi-implicit Euler. INTEGRATOR_EULER
+/// adds the angle's first order derivative and normalizes,
+/// the cheapest. INTEGRATOR_EXPONENTIAL_MAP turns the angle
+/// by exactly the angular velocity times the timestep, more 
+/// accurate for fast spinning bodies.
+///
+/// @author Leon Turpin
+/// @date November 2014
+////////////////////////////////////////////////////////////
+enum IntegratorType
+{
+	INTEGRATOR_EULER = 0,
+	INTEGRATOR_EXPONENTIAL_MAP = 1
+};
+
+////////////////////////////////////////////////////////////
+/// @brief The state of a world's bodies, stored by the world
+/// rather than in each body.
+///
+/// Every part of the state the bodies are moved with each
+/// update is an array of its own, a body's values at its
+/// index in the world's body list. Sweeps over the bodies
+/// then read memory in order, a SIMD register at a time.
+/// The things that are rarely touched, like collision
+/// shapes, restitution and friction, stay in the RigidBody,
+/// which reads and writes the rest through here while it's
+/// in a world.
+///
+/// The arrays are padded to a whole number of SIMD_LANES
+/// with bodies that are never integrated.
+///
+/// @author Leon Turpin
+/// @date November 2014
+////////////////////////////////////////////////////////////
+class BodyStorage
+{
+public:
+	////////////////////////////////////////////////////////////
+	/// @brief Default Constructor
+	////////////////////////////////////////////////////////////
+	BodyStorage();
+
+	////////////////////////////////////////////////////////////
+	/// @brief Add room for a body at the end of the arrays.
+	///
+	/// @return The new body's index.
+	///
+	////////////////////////////////////////////////////////////
+	unsigned int addBody();
+
+	////////////////////////////////////////////////////////////
+	/// @brief Remove a body by moving the last body into its
+	/// place, the same way the world's body list does.
+	///
+	/// @param index The body to remove.
+	///
+	////////////////////////////////////////////////////////////
+	void removeBody(unsigned int index);
+
+	unsigned int getNumBodies() const;
+
+	////////////////////////////////////////////////////////////
+	/// @brief Move every body marked to be integrated on by
+	/// timeStep, SIMD_LANES bodies at a time.
+	///
+	/// Does the same as RigidBody::integrate, and works out
+	/// the bodies' transforms and world inverse inertia
+	/// tensors in the same pass. Damping factors are only
+	/// worked out again when the timestep changes.
+	///
+	/// @param timeStep Time in seconds to simulate.
+	/// @param integrator How the bodies' angles are moved.
+	/// @param isGyroscopicTorqueEnabled True to turn the 
+	/// bodies' angular velocities as their angular momentum
+	/// wants, see _solveGyroscopic.
+	///
+	////////////////////////////////////////////////////////////
+	void integrate(const Scalar &timeStep, IntegratorType integrator, bool isGyroscopicTorqueEnabled);
+
+	////////////////////////////////////////////////////////////
+	/// @brief Work out a body's transform and world inverse
+	/// inertia tensor from its position and angle.
+	////////////////////////////////////////////////////////////
+	void calcDerivedData(unsigned int index) const;
+
+	////////////////////////////////////////////////////////////
+	/// @brief Mark a body's transform and world inverse 
+	/// inertia tensor out of date, after its position, angle
+	/// or inertia tensor is set. They're worked out again the
+	/// first time they're read, or by updateDerivedData.
+	////////////////////////////////////////////////////////////
+	void setDerivedDataDirty(unsigned int index) { m_isDerivedDataDirty[index] = 1; }
+
+	////////////////////////////////////////////////////////////
+	/// @brief Work out the derived data of every body marked
+	/// dirty. Called by the world once a step, before anything
+	/// reads the bodies from several threads at once.
+	////////////////////////////////////////////////////////////
+	void updateDerivedData();
+
+	////////////////////////////////////////////////////////////
+	/// @brief Set whether integrate moves a body, false for
+	/// sleeping bodies and articulation links.
+	////////////////////////////////////////////////////////////
+	void setIsIntegrated(unsigned int index, bool isIntegrated);
+
+	////////////////////////////////////////////////////////////
+	/// @brief Set a body's damping coefficients, the damping
+	/// factors for the current timestep follow.
+	////////////////////////////////////////////////////////////
+	void setDamping(unsigned int index, const Scalar &damping, const Scalar &angularDamping);
+
+	////////////////////////////////////////////////////////////
+	/// @brief Keep every body's position and angle as they
+	/// are now, before the world takes a step, to blend the 
+	/// rendered transforms from.
+	////////////////////////////////////////////////////////////
+	void storePreviousStates();
+
+	////////////////////////////////////////////////////////////
+	/// @brief Make a body's kept position and angle its 
+	/// current ones, so it doesn't blend in from wherever its
+	/// slot was before.
+	////////////////////////////////////////////////////////////
+	void resetPreviousState(unsigned int index);
+
+	////////////////////////////////////////////////////////////
+	/// @brief Blend a body's transform between its kept state
+	/// and its current one.
+	///
+	/// The position is interpolated linearly, the angle is 
+	/// too then normalized, taking the short way round. Close
+	/// enough to a slerp over a single step.
+	///
+	/// @param index The body.
+	/// @param alpha 0 for the kept state, 1 for the current.
+	///
+	/// @return The blended transform.
+	///
+	////////////////////////////////////////////////////////////
+	const Transform getInterpolatedTransform(unsigned int index, const Scalar &alpha) const;
+
+	const Vec3 getPosition(unsigned int index) const { return Vec3(m_position[0][index], m_position[1][index], m_position[2][index]); }
+	const Vec3 getVelocity(unsigned int index) const { return Vec3(m_velocity[0][index], m_velocity[1][index], m_velocity[2][index]); }
+	const Quat getAngle(unsigned int index) const { return Quat(m_angle[0][index], m_angle[1][index], m_angle[2][index], m_angle[3][index]); }
+	const Vec3 getAngularVelocity(unsigned int index) const { return Vec3(m_angularVelocity[0][index], m_angularVelocity[1][index], m_angularVelocity[2][index]); }
+	const Vec3 getForce(unsigned int index) const { return Vec3(m_force[0][index], m_force[1][index], m_force[2][index]); }
+	const Vec3 getTorque(unsigned int index) const { return Vec3(m_torque[0][index], m_torque[1][index], m_torque[2][index]); }
+	const Scalar getInvMass(unsigned int index) const { return m_invMass[index]; }
+	const Scalar getDamping(unsigned int index) const { return m_damping[index]; }
+	const Scalar getAngularDamping(unsigned int index) const { return m_angularDamping[index]; }
+
+	const Mat3& getInvInertiaTensorWorld(unsigned int index) const
+	{
+		if (m_isDerivedDataDirty[index]) { calcDerivedData(index); }
+		return m_invInertiaTensorWorld[index];
+	}
+
+	const Transform& getTransform(unsigned int index) const
+	{
+		if (m_isDerivedDataDirty[index]) { calcDerivedData(index); }
+		return m_transform[index];
+	}
+
+	const Mat3 getInvInertiaTensor(unsigned int index) const
+	{
+		Scalar data[9];
+
+		for (unsigned int i = 0; i < 9; i++)
+		{
+			data[i] = m_invInertiaTensor[i][index];
+		}
+
+		return Mat3(data);
+	}
+
+	void setPosition(unsigned int index, const Vec3 &position) { _set(m_position, index, position); }
+	void setVelocity(unsigned int index, const Vec3 &velocity) { _set(m_velocity, index, velocity); }
+	void setAngularVelocity(unsigned int index, const Vec3 &angularVelocity) { _set(m_angularVelocity, index, angularVelocity); }
+	void setForce(unsigned int index, const Vec3 &force) { _set(m_force, index, force); }
+	void setTorque(unsigned int index, const Vec3 &torque) { _set(m_torque, index, torque); }
+	void setInvMass(unsigned int index, const Scalar &invMass) { m_invMass[index] = invMass; }
+
+	void setAngle(unsigned int index, const Quat &angle)
+	{
+		m_angle[0][index] = angle.x;
+		m_angle[1][index] = angle.y;
+		m_angle[2][index] = angle.z;
+		m_angle[3][index] = angle.w;
+	}
+
+	void setInvInertiaTensor(unsigned int index, const Mat3 &invInertiaTensor)
+	{
+		for (unsigned int i = 0; i < 9; i++)
+		{
+			m_invInertiaTensor[i][index] = invInertiaTensor.get(i);
+		}
+	}
+
+private:
+	unsigned int m_numBodies;
+
+	// Hot data, read and written by every sweep, x, y, z (and w) arrays
+	ScalarArray m_position[3];
+	ScalarArray m_velocity[3];
+	ScalarArray m_angle[4];
+	ScalarArray m_angularVelocity[3];
+	ScalarArray m_force[3];
+	ScalarArray m_torque[3];
+	ScalarArray m_invMass;
+	ScalarArray m_invInertiaTensor[9]; // Body aligned
+	ScalarArray m_isIntegrated; // 1 if integrate moves the body, 0 if not
+
+	// How much of the velocities is kept over m_dampingTimeStep
+	ScalarArray m_linearDampingFactor;
+	ScalarArray m_angularDampingFactor;
+	Scalar m_dampingTimeStep;
+
+	// Only read when the timestep changes
+	ScalarArray m_damping;
+	ScalarArray m_angularDamping;
+
+	// Only read when rendering, the position and angle as they were before the last step
+	ScalarArray m_previousPosition[3];
+	ScalarArray m_previousAngle[4];
+
+	// Read by the collision detection and the solver, worked out when first read after a body moves
+	mutable std::vector<Transform> m_transform;
+	mutable std::vector<Mat3> m_invInertiaTensorWorld;
+	mutable std::vector<char> m_isDerivedDataDirty; // Not vector<bool>, the solver's threads mark neighbouring bodies
+
+	void _integrateLanes(unsigned int first, const Scalar &timeStep, IntegratorType integrator, bool isGyroscopicTorqueEnabled);
+	void _setDampingTimeStep(const Scalar &timeStep);
+
+	static void _set(ScalarArray (&arrays)[3], unsigned int index, const Vec3 &value)
+	{
+		arrays[0][index] = value.x;
+		arrays[1][index] = value.y;
+		arrays[2][index] = value.z;
+	}
+
+	template <unsigned int N>
+	static void _grow(ScalarArray (&arrays)[N]);
+
+	template <unsigned int N>
+	static void _moveLast(ScalarArray (&arrays)[N], unsigned int index, unsigned int last);
+};
+
+/**
+ * @brief Do an inertia tensor rotation by a transformation matrix.
+ *
+ * Taken from "Game Physics Engine Development" by Ian Millington.
+ *
+ * @param iitWorld The resulting world aligned inverse inertia tensor.
+ * @param iitBody The original rigidbody aligned inverse inertia tensor.
+ * @param rotMat The transformation to rotate the inertia tensor by.
+ */
+void _transformInertiaTensor(Mat3 &iitWorld, const Mat3 &iitBody, const Transform &rotMat);
+
+/**
+ * @brief Turn an angle by an angular velocity for a timestep.
+ *
+ * @param angle The angle to turn.
+ * @param angularVelocity World space angular velocity, in radians per second.
+ * @param timeStep Time in seconds to turn for.
+ * @param integrator INTEGRATOR_EULER for the first order update, INTEGRATOR_EXPONENTIAL_MAP for the exact one.
+ *
+ * @return The turned angle, normalized.
+ */
+const Quat _integrateAngle(const Quat &angle, const Vec3 &angularVelocity, const Scalar &timeStep, IntegratorType integrator);
+
+/**
+ * @brief Add the gyroscopic torque to an angular velocity,
+ * implicitly so spinning bodies don't gain energy.
+ *
+ * A body spinning about an axis that isn't one of its
+ * principal axes wobbles as its angular velocity turns to
+ * keep its angular momentum. Taken explicitly the torque
+ * that does this blows up, so the velocity after the step
+ * is found with a Newton step in body space, as in Erin 
+ * Catto's "Numerical Methods" talk, GDC 2015.
+ *
+ * @param angularVelocity World space angular velocity.
+ * @param invInertiaTensor The body aligned inverse inertia tensor.
+ * @param transform The body's transform, for its rotation.
+ * @param timeStep Time in seconds to simulate.
+ *
+ * @return The new world space angular velocity.
+ */
+const Vec3 _solveGyroscopic(const Vec3 &angularVelocity, const Mat3 &invInertiaTensor, const Transform &transform, const Scalar &timeStep);
+
+} // namespace lt
+
+#endif // LTPHYS_BODYSTORAGE_HPP
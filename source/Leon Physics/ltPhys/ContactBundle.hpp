@@ -0,0 +1,123 @@
+#ifndef LTPHYS_CONTACTBUNDLE_HPP
+#define LTPHYS_CONTACTBUNDLE_HPP
+
+#include "RigidBody.hpp"
+#include "ContactPoint.hpp"
+#include "SimdFloat.hpp"
+
+namespace lt
+{
+
+////////////////////////////////////////////////////////////
+/// @brief A contact point from each of SIMD_LANES manifolds,
+/// prepared to be solved together in SIMD lanes.
+///
+/// Values are stored a lane per float, so each row loads
+/// straight into a SimdFloat. No two lanes share a dynamic
+/// body, so every lane's impulse can be applied at once.
+/// Lanes without a contact have null bodies and an effective
+/// mass of zero, they never apply an impulse.
+///
+/// @author Leon Turpin
+/// @date November 2014
+////////////////////////////////////////////////////////////
+struct ContactBundle
+{
+	/** The contact normals, x, y and z rows */
+	Scalar normal[3][SIMD_LANES];
+
+	/** Angular part of body 1's jacobian, the contact position relative to body 1 crossed with the normal */
+	Scalar angularA[3][SIMD_LANES];
+
+	/** Angular part of body 2's jacobian */
+	Scalar angularB[3][SIMD_LANES];
+
+	/** Body 1's world inverse inertia tensor times its angular jacobian */
+	Scalar invInertiaAngularA[3][SIMD_LANES];
+
+	/** Body 2's world inverse inertia tensor times its angular jacobian */
+	Scalar invInertiaAngularB[3][SIMD_LANES];
+
+	Scalar invMassA[SIMD_LANES];
+	Scalar invMassB[SIMD_LANES];
+
+	/** One over the mass the impulse acts against along the normal */
+	Scalar effectiveMass[SIMD_LANES];
+
+	/** The separating velocity each contact aims for */
+	Scalar targetVelocity[SIMD_LANES];
+
+	/** The total impulse applied along the normal */
+	Scalar normalImpulse[SIMD_LANES];
+
+	/** The tangents of each contact, x, y and z rows */
+	Scalar tangent[2][3][SIMD_LANES];
+
+	/** Angular parts of the tangents' jacobians */
+	Scalar tangentAngularA[2][3][SIMD_LANES];
+	Scalar tangentAngularB[2][3][SIMD_LANES];
+
+	/** The bodies' world inverse inertia tensors times the tangents' angular jacobians */
+	Scalar tangentInvInertiaAngularA[2][3][SIMD_LANES];
+	Scalar tangentInvInertiaAngularB[2][3][SIMD_LANES];
+
+	/** One over the mass the impulse acts against along each tangent */
+	Scalar tangentEffectiveMass[2][SIMD_LANES];
+
+	/** The combined coefficient of friction of each contact */
+	Scalar friction[SIMD_LANES];
+
+	/** The total friction impulse applied along each tangent */
+	Scalar tangentImpulse[2][SIMD_LANES];
+
+	/** The separating pseudo velocity that pushes the bodies out of each other */
+	Scalar penetrationBias[SIMD_LANES];
+
+	/** The total pseudo impulse applied along the normal */
+	Scalar pushImpulse[SIMD_LANES];
+
+	/** Index of each body in its island, static bodies and empty lanes index a zero entry past the end */
+	unsigned int indexA[SIMD_LANES];
+	unsigned int indexB[SIMD_LANES];
+
+	/** Index of each lane's own copy of its bodies' velocities when mass splitting, empty lanes index a zero entry past the end */
+	unsigned int slotA[SIMD_LANES];
+	unsigned int slotB[SIMD_LANES];
+
+	RigidBody* bodyA[SIMD_LANES];
+	RigidBody* bodyB[SIMD_LANES];
+
+	/** The contact each lane was prepared from */
+	ContactPoint* contacts[SIMD_LANES];
+};
+
+/** Most contacts of a manifold whose normal impulses are solved together */
+const unsigned int MAX_BLOCK_CONTACTS = 4;
+
+////////////////////////////////////////////////////////////
+/// @brief The contacts of one manifold, prepared to have 
+/// their normal impulses solved together.
+///
+/// The coupling matrix holds how much an impulse at each 
+/// contact changes the separating velocity at every other.
+/// Contact i of the manifold is in lane's slot of the i'th
+/// bundle of its group.
+///
+/// @author Leon Turpin
+/// @date November 2014
+////////////////////////////////////////////////////////////
+struct ContactBlock
+{
+	/** Number of contacts in the manifold, 0 for an empty lane */
+	unsigned int numContacts;
+
+	/** False if the coupling matrix is too close to singular, the contacts are then solved one at a time */
+	bool isInvertible;
+
+	Scalar coupling[MAX_BLOCK_CONTACTS][MAX_BLOCK_CONTACTS];
+	Scalar invCoupling[MAX_BLOCK_CONTACTS][MAX_BLOCK_CONTACTS];
+};
+
+} // namespace lt
+
+#endif // LTPHYS_CONTACTBUNDLE_HPP
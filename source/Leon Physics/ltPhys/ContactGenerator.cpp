@@ -7,6 +7,8 @@ namespace lt
 {
 
 static inline Scalar transformToAxis(const ShapeBox &box, const Transform &boxTransform, const Vec3 &axis); 
+static inline int findMatchingContact(const ContactPoint &contact, const std::vector<ContactPoint> &contacts, const Scalar &matchDistance);
+static inline bool isMoving(const RigidBody &body);
 static inline Scalar penetrationOnAxis(const ShapeBox &boxA, const Transform &boxATransform, const ShapeBox &boxB, const Transform &boxBTransform, const Vec3 &axis, const Vec3 &separation);
 static inline bool tryAxis(const ShapeBox &boxA, const Transform &boxATransform, const ShapeBox &boxB, const Transform &boxBTransform, Vec3 axis, const Vec3 &separation, unsigned int index, Scalar &smallestPenetration, unsigned int &smallestCase);
 static inline Vec3 contactPoint(const Vec3 &pOne, const Vec3 &dOne, Scalar sizeOne, const Vec3 &pTwo, const Vec3 &dTwo, Scalar sizeTwo, bool useOne);
@@ -15,8 +17,25 @@ void fillPointFaceBoxBox(const ShapeBox &boxA, const Transform &boxATransform, c
 static inline Vec3 getShapeAxis(const ShapeBox &box, const Transform &boxTransform, unsigned int index);
 static inline Scalar transformToAxis(const ShapeBox &box, const Transform &boxTransform, const Vec3 &axis);
 
+ContactGenerator::ContactGenerator()
+{
+	m_updateCount = 0;
+	m_numPairsChecked = 0;
+	m_numPairsReused = 0;
+
+	m_maxContactsPerPair = 4;
+	m_contactMergeDistance = 0.01f;
+	m_contactMatchDistance = 0.02f;
+
+	setReuseTolerance(0.001f, 0.05f);
+}
+
 void ContactGenerator::generateContacts(std::vector<RigidBody*>& rigidBodies, std::vector<ContactManifold>& contactManifolds)
 {
+	m_updateCount++;
+	m_numPairsChecked = 0;
+	m_numPairsReused = 0;
+
 	// For each rigid body with each other rigid body
 	for(unsigned int i = 0; i < rigidBodies.size(); i++)
 	{
@@ -24,23 +43,197 @@ void ContactGenerator::generateContacts(std::vector<RigidBody*>& rigidBodies, st
 		{
 			for (unsigned int j = i+1; j < rigidBodies.size(); j++)
 			{
+				// Articulation links overlap their parent at the joint
+				if (rigidBodies[i]->getArticulationParent() == rigidBodies[j] || rigidBodies[j]->getArticulationParent() == rigidBodies[i])
+				{
+					continue;
+				}
+
 				if(rigidBodies[j]->numCollisionShapes() != 0)
 				{
-					checkCollision(*rigidBodies[i], *rigidBodies[j], contactManifolds);
+					// Pairs where neither body can move keep their contacts as they were
+					if (isMoving(*rigidBodies[i]) || isMoving(*rigidBodies[j]))
+					{
+						checkCollision(*rigidBodies[i], *rigidBodies[j], contactManifolds);
+					}
+					else
+					{
+						_keepPairContacts(*rigidBodies[i], *rigidBodies[j], contactManifolds);
+					}
 				}
 			}
 		}
 	}
+
+	// Forget pairs that weren't checked this update
+	std::map<BodyPair, PersistentPair>::iterator pairIter = m_persistentPairs.begin();
+	while (pairIter != m_persistentPairs.end())
+	{
+		if (pairIter->second.lastUpdate != m_updateCount)
+		{
+			m_persistentPairs.erase(pairIter++);
+		}
+		else
+		{
+			++pairIter;
+		}
+	}
 }
 
 void ContactGenerator::checkCollision(RigidBody &rbA, RigidBody &rbB, std::vector<ContactManifold>& contactManifolds)
+{
+	ContactManifold manifold(rbA, rbB);
+
+	m_numPairsChecked++;
+
+	// Where body B is relative to body A
+	Vec3 relPosition = rbA.getTransform().transformInvP(rbB.getPosition());
+	Quat relAngle = rbA.getAngle().inverse() * rbB.getAngle();
+
+	// Only pairs that were touching last update are remembered, separated pairs are just checked again
+	std::map<BodyPair, PersistentPair>::iterator pairIter = m_persistentPairs.find(BodyPair(&rbA, &rbB));
+	bool isKnownPair = (pairIter != m_persistentPairs.end());
+
+	Vec3 relMovement = isKnownPair ? relPosition - pairIter->second.relPosition : Vec3(0, 0, 0);
+
+	if (isKnownPair &&
+		relMovement.dot(relMovement) <= m_reusePosTolerance * m_reusePosTolerance &&
+		std::abs(relAngle.dot(pairIter->second.relAngle)) >= m_reuseCosHalfAngTolerance)
+	{
+		pairIter->second.lastUpdate = m_updateCount;
+		_reusePairContacts(pairIter->second, rbA, rbB, manifold);
+		m_numPairsReused++;
+	}
+	else
+	{
+		_generatePairContacts(rbA, rbB, manifold);
+
+		if (manifold.getNumContacts() > 0)
+		{
+			if (!isKnownPair)
+			{
+				pairIter = m_persistentPairs.insert(std::make_pair(BodyPair(&rbA, &rbB), PersistentPair())).first;
+			}
+
+			PersistentPair &pair = pairIter->second;
+			pair.lastUpdate = m_updateCount;
+
+			// Contacts that match last update's contacts start with their impulses
+			for (int i = 0; i < manifold.getNumContacts(); i++)
+			{
+				ContactPoint &pt = manifold.getContactPoint(i);
+				int match = findMatchingContact(pt, pair.contactPoints, m_contactMatchDistance);
+
+				if (match >= 0)
+				{
+					pt.normalImpulse = pair.contactPoints[match].normalImpulse;
+					pt.tangentImpulse[0] = pair.contactPoints[match].tangentImpulse[0];
+					pt.tangentImpulse[1] = pair.contactPoints[match].tangentImpulse[1];
+				}
+			}
+
+			// Remember the transform these contacts were generated at
+			pair.relPosition = relPosition;
+			pair.relAngle = relAngle;
+			pair.contactPoints.clear();
+
+			for (int i = 0; i < manifold.getNumContacts(); i++)
+			{
+				pair.contactPoints.push_back(manifold.getContactPoint(i));
+			}
+		}
+	}
+
+	if(manifold.getNumContacts() > 0)
+	{
+		contactManifolds.push_back(manifold);
+	}
+}
+
+void ContactGenerator::setMaxContactsPerPair(unsigned int maxContacts)
+{
+	m_maxContactsPerPair = (maxContacts < 4) ? 4 : ((maxContacts > 8) ? 8 : maxContacts);
+}
+
+void ContactGenerator::setContactMergeDistance(const Scalar& mergeDistance) { m_contactMergeDistance = mergeDistance; }
+
+void ContactGenerator::setReuseTolerance(const Scalar& positionTolerance, const Scalar& angleTolerance)
+{
+	const Scalar DEG_TO_RAD = 0.0174532925f;
+
+	m_reusePosTolerance = positionTolerance;
+	m_reuseAngTolerance = angleTolerance;
+	m_reuseCosHalfAngTolerance = cos(angleTolerance * DEG_TO_RAD * 0.5f);
+}
+
+void ContactGenerator::setContactMatchDistance(const Scalar& matchDistance) { m_contactMatchDistance = matchDistance; }
+
+void ContactGenerator::cacheImpulses(const std::vector<ContactManifold>& contactManifolds)
+{
+	for (unsigned int i = 0; i < contactManifolds.size(); i++)
+	{
+		const ContactManifold &manifold = contactManifolds[i];
+
+		std::map<BodyPair, PersistentPair>::iterator pairIter = 
+			m_persistentPairs.find(BodyPair(&manifold.getBody0(), &manifold.getBody1()));
+
+		if (pairIter == m_persistentPairs.end()) { continue; }
+
+		std::vector<ContactPoint> &cachedPoints = pairIter->second.contactPoints;
+
+		for (int j = 0; j < manifold.getNumContacts(); j++)
+		{
+			const ContactPoint pt = manifold.getContactPoint(j);
+			int match = findMatchingContact(pt, cachedPoints, m_contactMatchDistance);
+
+			if (match >= 0)
+			{
+				cachedPoints[match].normalImpulse = pt.normalImpulse;
+				cachedPoints[match].tangentImpulse[0] = pt.tangentImpulse[0];
+				cachedPoints[match].tangentImpulse[1] = pt.tangentImpulse[1];
+			}
+		}
+	}
+}
+
+void ContactGenerator::removeBody(const RigidBody* body)
+{
+	std::map<BodyPair, PersistentPair>::iterator pairIter = m_persistentPairs.begin();
+	while (pairIter != m_persistentPairs.end())
+	{
+		if (pairIter->first.first == body || pairIter->first.second == body)
+		{
+			m_persistentPairs.erase(pairIter++);
+		}
+		else
+		{
+			++pairIter;
+		}
+	}
+}
+
+unsigned int ContactGenerator::getMaxContactsPerPair() const { return m_maxContactsPerPair; }
+const Scalar& ContactGenerator::getContactMergeDistance() const { return m_contactMergeDistance; }
+const Scalar& ContactGenerator::getContactMatchDistance() const { return m_contactMatchDistance; }
+const Scalar& ContactGenerator::getReusePositionTolerance() const { return m_reusePosTolerance; }
+const Scalar& ContactGenerator::getReuseAngleTolerance() const { return m_reuseAngTolerance; }
+unsigned int ContactGenerator::getNumPairsChecked() const { return m_numPairsChecked; }
+unsigned int ContactGenerator::getNumPairsReused() const { return m_numPairsReused; }
+
+const Scalar ContactGenerator::getPairReuseRate() const
+{
+	return (m_numPairsChecked > 0) ? (Scalar)m_numPairsReused / (Scalar)m_numPairsChecked : 0;
+}
+
+//--------------------------
+//	PRIVATES			
+//--------------------------
+
+void ContactGenerator::_generatePairContacts(RigidBody &rbA, RigidBody &rbB, ContactManifold &manifold)
 {
 	const std::set<const CollisionShape*>& colShapesA = rbA.getCollisionShapes();
 	const std::set<const CollisionShape*>& colShapesB = rbB.getCollisionShapes();
 
-	ContactManifold normManifold(rbA, rbB);
-	ContactManifold swappedManifold(rbB, rbA);
-
 	std::set<const CollisionShape*>::iterator i;
 	std::set<const CollisionShape*>::iterator j;
 	for (i = colShapesA.begin(); i != colShapesA.end(); ++i)
@@ -54,7 +247,7 @@ void ContactGenerator::checkCollision(RigidBody &rbA, RigidBody &rbB, std::vecto
 			const CollisionShape *shape2 = *j;
 			RigidBody *body1 = &rbA;
 			RigidBody *body2 = &rbB;
-			ContactManifold *curManifold = &normManifold;
+			bool isSwapped = false;
 
 			if (shapeAType > shapeBType)
 			{
@@ -67,48 +260,104 @@ void ContactGenerator::checkCollision(RigidBody &rbA, RigidBody &rbB, std::vecto
 				RigidBody *tempBody = body1; 
 				body1 = body2;
 				body2 = tempBody;
-				curManifold = &swappedManifold;
+				isSwapped = true;
 			}
 
+			int firstNewContact = manifold.getNumContacts();
+
 			//HACK: check Collisions else if thing. Make this a better thing
 			if(shapeAType == SHAPE_SPHERE && shapeBType == SHAPE_SPHERE)
 			{
-				ContactGenerator::sphere_sphere(*shape1, *body1, *shape2, *body2, *curManifold);
+				ContactGenerator::sphere_sphere(*shape1, *body1, *shape2, *body2, manifold);
 			}
 			else if(shapeAType == SHAPE_SPHERE && shapeBType == SHAPE_HALFSPACE)
 			{
-				ContactGenerator::sphere_halfspace(*shape1, *body1, *shape2, *body2, *curManifold);
+				ContactGenerator::sphere_halfspace(*shape1, *body1, *shape2, *body2, manifold);
 			}
 			else if(shapeAType == SHAPE_BOX && shapeBType == SHAPE_BOX)
 			{
-				ContactGenerator::box_box(*shape1, *body1, *shape2, *body2, *curManifold);
+				ContactGenerator::box_box(*shape1, *body1, *shape2, *body2, manifold);
 			}
 			else if(shapeAType == SHAPE_BOX && shapeBType == SHAPE_HALFSPACE)
 			{
-				ContactGenerator::box_halfspace(*shape1, *body1, *shape2, *body2, *curManifold);
+				ContactGenerator::box_halfspace(*shape1, *body1, *shape2, *body2, manifold);
 			}
 			else
 			{
 				//std::cout << "CollisionRegistry::Unhandled collision type (" << shapeAType << ", " << shapeBType << ")\n";
 			}
+
+			// Contacts generated with the bodies swapped have their normals pointing the wrong way.
+			if (isSwapped)
+			{
+				for (int k = firstNewContact; k < manifold.getNumContacts(); ++k)
+				{
+					ContactPoint &newContact = manifold.getContactPoint(k);
+					newContact.normal = -newContact.normal;
+				}
+			}
 		}
 	}
 
-	// Convert all swapped manifolds to normal manifolds.
-	for(int i = 0; i < swappedManifold.getNumContacts(); ++i)
+	if(manifold.getNumContacts() > 0)
 	{
-		ContactPoint newContact;
+		// Keep the solver's work per body pair bounded, no matter how many child shapes there are.
+		manifold.reduceContacts(m_maxContactsPerPair, m_contactMergeDistance);
 
-		newContact = swappedManifold.getContactPoint(i);
+		// Store the contacts in body space so they can be reused while the bodies don't move relative to each other.
+		for (int i = 0; i < manifold.getNumContacts(); i++)
+		{
+			ContactPoint &pt = manifold.getContactPoint(i);
+			Vec3 halfPen = pt.normal * (pt.penetration * 0.5f);
 
-		newContact.normal = -newContact.normal;
+			pt.localPosition0 = rbA.getTransform().transformInvP(pt.position - halfPen);
+			pt.localPosition1 = rbB.getTransform().transformInvP(pt.position + halfPen);
+			pt.localNormal1 = rbB.getTransform().transformInvV(pt.normal);
+		}
+	}
+}
+
+void ContactGenerator::_keepPairContacts(RigidBody &rbA, RigidBody &rbB, std::vector<ContactManifold>& contactManifolds)
+{
+	std::map<BodyPair, PersistentPair>::iterator pairIter = m_persistentPairs.find(BodyPair(&rbA, &rbB));
+
+	if (pairIter == m_persistentPairs.end()) { return; }
+
+	PersistentPair &pair = pairIter->second;
+	pair.lastUpdate = m_updateCount;
+
+	if (!pair.contactPoints.empty())
+	{
+		ContactManifold manifold(rbA, rbB);
 
-		normManifold.addContactPoint(newContact);
+		for (unsigned int i = 0; i < pair.contactPoints.size(); i++)
+		{
+			manifold.addContactPoint(pair.contactPoints[i]);
+		}
+
+		contactManifolds.push_back(manifold);
 	}
+}
 
-	if(normManifold.getNumContacts() > 0)
+void ContactGenerator::_reusePairContacts(const PersistentPair &pair, RigidBody &rbA, RigidBody &rbB, ContactManifold &manifold)
+{
+	for (unsigned int i = 0; i < pair.contactPoints.size(); i++)
 	{
-		contactManifolds.push_back(normManifold);
+		ContactPoint pt = pair.contactPoints[i];
+
+		// Move the stored contact along with the bodies
+		Vec3 pointA = rbA.getTransform() * pt.localPosition0;
+		Vec3 pointB = rbB.getTransform() * pt.localPosition1;
+
+		pt.normal = rbB.getTransform() * pt.localNormal1;
+		pt.penetration = (pointB - pointA).dot(pt.normal);
+		pt.position = (pointA + pointB) * 0.5f;
+
+		// Drop points that have separated
+		if (pt.penetration >= 0)
+		{
+			manifold.addContactPoint(pt);
+		}
 	}
 }
 
@@ -413,6 +662,31 @@ void fillPointFaceBoxBox(const ShapeBox &boxA, const Transform &boxATransform,
 	contactManifold.addContactPoint(newContact);
 }
 
+static inline int findMatchingContact(const ContactPoint &contact, const std::vector<ContactPoint> &contacts, const Scalar &matchDistance)
+{
+	int bestMatch = -1;
+	Scalar bestDistSq = matchDistance * matchDistance;
+
+	for (unsigned int i = 0; i < contacts.size(); i++)
+	{
+		Vec3 offset = contact.localPosition0 - contacts[i].localPosition0;
+		Scalar distSq = offset.dot(offset);
+
+		if (distSq <= bestDistSq && contact.localNormal1.dot(contacts[i].localNormal1) > 0.9f)
+		{
+			bestDistSq = distSq;
+			bestMatch = i;
+		}
+	}
+
+	return bestMatch;
+}
+
+static inline bool isMoving(const RigidBody &body)
+{
+	return body.isAwake() && body.getInvMass() != 0;
+}
+
 static inline Vec3 getShapeAxis(const ShapeBox &box, const Transform &boxTransform, unsigned int index)
 {
 	return Vec3(boxTransform.get(index), boxTransform.get(index+4), boxTransform.get(index+8));
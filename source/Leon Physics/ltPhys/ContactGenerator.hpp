@@ -2,6 +2,8 @@
 #define LTPHYS_CONTACTGENERATOR_H
 
 #include <vector>
+#include <map>
+#include <utility>
 
 #include "../lt3DMath/lt3DMath.hpp"
 
@@ -16,7 +18,9 @@ namespace lt
 {
 
 ////////////////////////////////////////////////////////////
-/// @brief Provides a set of static functions to check contact with.
+/// @brief Generates the contact manifolds between rigid bodies.
+/// Also provides a set of static functions to check contact
+/// between pairs of collision shapes with.
 ///
 /// @author Leon Turpin
 /// @date February 2014
@@ -24,17 +28,98 @@ namespace lt
 class ContactGenerator
 {
 public:	
+	////////////////////////////////////////////////////////////
+	/// @brief Default Constructor
+	////////////////////////////////////////////////////////////
+	ContactGenerator();
+
 	////////////////////////////////////////////////////////////
 	/// @brief Check for contact between all rigid bodies
 	/// Adds the contact data to the contact manifolds vector
+	///
+	/// Pairs where neither body is awake and dynamic aren't 
+	/// checked, their last contacts are added as they were.
 	////////////////////////////////////////////////////////////
-	static void generateContacts(std::vector<RigidBody*>& rigidBodies, std::vector<ContactManifold>& contactManifolds);
+	void generateContacts(std::vector<RigidBody*>& rigidBodies, std::vector<ContactManifold>& contactManifolds);
 
 	////////////////////////////////////////////////////////////
-	/// @brief Check for contact between two rigid bodies
-	/// Adds the contact data to the contact manifolds vector
+	/// @brief Check for contact between two rigid bodies.
+	/// The contacts of every pair of child shapes are gathered 
+	/// into one manifold, which is then reduced before being
+	/// added to the contact manifolds vector.
 	////////////////////////////////////////////////////////////
-	static void checkCollision(RigidBody &rbA, RigidBody &rbB, std::vector<ContactManifold>& contactManifolds);
+	void checkCollision(RigidBody &rbA, RigidBody &rbB, std::vector<ContactManifold>& contactManifolds);
+
+	////////////////////////////////////////////////////////////
+	/// @brief Set the maximum number of contacts kept per 
+	/// body pair. Clamped between 4 and 8.
+	////////////////////////////////////////////////////////////
+	void setMaxContactsPerPair(unsigned int maxContacts);
+
+	////////////////////////////////////////////////////////////
+	/// @brief Set the distance under which two contacts of a 
+	/// body pair are merged into one.
+	////////////////////////////////////////////////////////////
+	void setContactMergeDistance(const Scalar& mergeDistance);
+
+	////////////////////////////////////////////////////////////
+	/// @brief Set how far a body pair may move relative to each 
+	/// other before its contacts are generated again. Until then
+	/// the pair's previous contacts are reused and only their
+	/// penetration depths are updated.
+	///
+	/// @param positionTolerance Relative position tolerance.
+	/// @param angleTolerance Relative rotation tolerance in degrees.
+	///
+	////////////////////////////////////////////////////////////
+	void setReuseTolerance(const Scalar& positionTolerance, const Scalar& angleTolerance);
+
+	////////////////////////////////////////////////////////////
+	/// @brief Set the distance a contact point can move, in 
+	/// body space, and still be considered the same contact
+	/// as last update. Matched contacts keep their impulses.
+	////////////////////////////////////////////////////////////
+	void setContactMatchDistance(const Scalar& matchDistance);
+
+	////////////////////////////////////////////////////////////
+	/// @brief Store the impulses the resolver applied to each
+	/// contact, so next update's matching contacts can start
+	/// from them.
+	///
+	/// @param contactManifolds The manifolds generated and 
+	/// resolved this update.
+	///
+	////////////////////////////////////////////////////////////
+	void cacheImpulses(const std::vector<ContactManifold>& contactManifolds);
+
+	////////////////////////////////////////////////////////////
+	/// @brief Forget the cached contacts of every pair 
+	/// involving the given body.
+	////////////////////////////////////////////////////////////
+	void removeBody(const RigidBody* body);
+
+	unsigned int getMaxContactsPerPair() const;
+	const Scalar& getContactMergeDistance() const;
+	const Scalar& getContactMatchDistance() const;
+	const Scalar& getReusePositionTolerance() const;
+	const Scalar& getReuseAngleTolerance() const;
+
+	////////////////////////////////////////////////////////////
+	/// @brief Get the number of body pairs checked last update.
+	////////////////////////////////////////////////////////////
+	unsigned int getNumPairsChecked() const;
+
+	////////////////////////////////////////////////////////////
+	/// @brief Get the number of body pairs that reused their
+	/// previous contacts last update.
+	////////////////////////////////////////////////////////////
+	unsigned int getNumPairsReused() const;
+
+	////////////////////////////////////////////////////////////
+	/// @brief Get the fraction of body pairs checked last update
+	/// that skipped the narrowphase.
+	////////////////////////////////////////////////////////////
+	const Scalar getPairReuseRate() const;
 
 	////////////////////////////////////////////////////////////
 	/// @brief Check for contact between a sphere and a sphere
@@ -57,6 +142,40 @@ public:
 	/// @brief Check for contact between a box and a halfspace
 	////////////////////////////////////////////////////////////
 	static void box_halfspace(const CollisionShape &a, const RigidBody &rbA, const CollisionShape &b, const RigidBody &rbB, ContactManifold &contactManifold);
+
+private:
+	////////////////////////////////////////////////////////////
+	/// @brief The contacts of a touching body pair along with
+	/// the relative transform they were generated at.
+	////////////////////////////////////////////////////////////
+	struct PersistentPair
+	{
+		Vec3 relPosition; // Position of body 2 in body 1's space
+		Quat relAngle; // Orientation of body 2 relative to body 1
+		std::vector<ContactPoint> contactPoints;
+		unsigned int lastUpdate; // Last update the pair was checked
+
+		PersistentPair() : lastUpdate(0) {}
+	};
+
+	typedef std::pair<const RigidBody*, const RigidBody*> BodyPair;
+
+	std::map<BodyPair, PersistentPair> m_persistentPairs;
+	unsigned int m_updateCount;
+
+	unsigned int m_maxContactsPerPair; // Maximum contacts kept per body pair
+	Scalar m_contactMergeDistance; // Contacts closer than this are merged
+	Scalar m_contactMatchDistance; // Contacts that moved less than this are the same contact as last update
+	Scalar m_reusePosTolerance; // Relative movement allowed before regenerating contacts
+	Scalar m_reuseAngTolerance; // Relative rotation allowed before regenerating contacts (degrees)
+	Scalar m_reuseCosHalfAngTolerance; // Cosine of half the rotation tolerance
+
+	unsigned int m_numPairsChecked;
+	unsigned int m_numPairsReused;
+
+	void _generatePairContacts(RigidBody &rbA, RigidBody &rbB, ContactManifold &manifold);
+	void _keepPairContacts(RigidBody &rbA, RigidBody &rbB, std::vector<ContactManifold>& contactManifolds);
+	void _reusePairContacts(const PersistentPair &pair, RigidBody &rbA, RigidBody &rbB, ContactManifold &manifold);
 };
 
 } // namespace lt
@@ -3,6 +3,8 @@
 namespace lt
 {
 
+static inline Scalar distanceToSegmentSq(const Vec3 &point, const Vec3 &segStart, const Vec3 &segEnd);
+
 ContactManifold::ContactManifold(RigidBody &body0, RigidBody &body1)
 : m_body0(body0), m_body1(body1)
 {}
@@ -17,6 +19,16 @@ RigidBody& ContactManifold::getBody1()
 	return m_body1;
 }
 
+const RigidBody& ContactManifold::getBody0() const
+{
+	return m_body0;
+}
+
+const RigidBody& ContactManifold::getBody1() const
+{
+	return m_body1;
+}
+
 void ContactManifold::addContactPoint(const ContactPoint& contactPt)
 {
 	m_contactPoints.push_back(contactPt);
@@ -27,7 +39,7 @@ int ContactManifold::getNumContacts() const
 	return m_contactPoints.size();
 }
 
-ContactPoint ContactManifold::getContactPoint(int index)
+ContactPoint& ContactManifold::getContactPoint(int index)
 {
 	return m_contactPoints[index];
 }
@@ -37,6 +49,138 @@ const ContactPoint ContactManifold::getContactPoint(int index) const
 	return m_contactPoints[index];
 }
 
+void ContactManifold::updateContacts()
+{
+	for (unsigned int i = 0; i < m_contactPoints.size(); i++)
+	{
+		ContactPoint &pt = m_contactPoints[i];
+
+		Vec3 point0 = m_body0.getTransform() * pt.localPosition0;
+		Vec3 point1 = m_body1.getTransform() * pt.localPosition1;
+
+		pt.normal = m_body1.getTransform() * pt.localNormal1;
+		pt.penetration = (point1 - point0).dot(pt.normal);
+		pt.position = (point0 + point1) * 0.5f;
+	}
+}
+
+void ContactManifold::reduceContacts(unsigned int maxContacts, const Scalar& mergeDistance)
+{
+	const Scalar mergeDistanceSq = mergeDistance * mergeDistance;
+
+	// Merge near coincident points, keeping the deepest of them.
+	std::vector<ContactPoint> merged;
+	merged.reserve(m_contactPoints.size());
+
+	for (unsigned int i = 0; i < m_contactPoints.size(); i++)
+	{
+		const ContactPoint &curPoint = m_contactPoints[i];
+		bool isDuplicate = false;
+
+		for (unsigned int j = 0; j < merged.size(); j++)
+		{
+			Vec3 offset = curPoint.position - merged[j].position;
+
+			if (offset.dot(offset) <= mergeDistanceSq && curPoint.normal.dot(merged[j].normal) > 0)
+			{
+				if (curPoint.penetration > merged[j].penetration)
+				{
+					merged[j] = curPoint;
+				}
+
+				isDuplicate = true;
+				break;
+			}
+		}
+
+		if (!isDuplicate)
+		{
+			merged.push_back(curPoint);
+		}
+	}
+
+	if (merged.size() <= maxContacts || maxContacts == 0)
+	{
+		m_contactPoints.swap(merged);
+		return;
+	}
+
+	// Too many points, pick the deepest one first.
+	std::vector<bool> isChosen(merged.size(), false);
+	std::vector<ContactPoint> reduced;
+	reduced.reserve(maxContacts);
+
+	unsigned int deepest = 0;
+	for (unsigned int i = 1; i < merged.size(); i++)
+	{
+		if (merged[i].penetration > merged[deepest].penetration)
+		{
+			deepest = i;
+		}
+	}
+
+	reduced.push_back(merged[deepest]);
+	isChosen[deepest] = true;
+
+	// Then keep adding the point that's furthest from the points chosen so far.
+	// The second point maximizes the distance to the first, the third maximizes 
+	// the area of the triangle, and the rest fill in around the outline.
+	while (reduced.size() < maxContacts)
+	{
+		unsigned int bestIndex = 0;
+		Scalar bestScore = -1;
+
+		for (unsigned int i = 0; i < merged.size(); i++)
+		{
+			if (isChosen[i]) { continue; }
+
+			Scalar score = SCALAR_MAX;
+
+			if (reduced.size() == 2)
+			{
+				score = distanceToSegmentSq(merged[i].position, reduced[0].position, reduced[1].position);
+			}
+			else
+			{
+				for (unsigned int j = 0; j < reduced.size(); j++)
+				{
+					Vec3 offset = merged[i].position - reduced[j].position;
+					Scalar distSq = offset.dot(offset);
+					score = (distSq < score) ? distSq : score;
+				}
+			}
+
+			if (score > bestScore)
+			{
+				bestScore = score;
+				bestIndex = i;
+			}
+		}
+
+		reduced.push_back(merged[bestIndex]);
+		isChosen[bestIndex] = true;
+	}
+
+	m_contactPoints.swap(reduced);
+}
+
+//--------------------------
+//	HELPERS		
+//--------------------------
+
+static inline Scalar distanceToSegmentSq(const Vec3 &point, const Vec3 &segStart, const Vec3 &segEnd)
+{
+	Vec3 segment = segEnd - segStart;
+	Vec3 toPoint = point - segStart;
+	Scalar segLengthSq = segment.dot(segment);
+
+	Scalar t = (segLengthSq > 0) ? toPoint.dot(segment) / segLengthSq : 0;
+	t = (t < 0) ? 0 : ((t > 1) ? 1 : t);
+
+	Vec3 offset = toPoint - segment * t;
+	return offset.dot(offset);
+}
+
 
 } // namespace lt
 
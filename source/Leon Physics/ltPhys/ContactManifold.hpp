@@ -32,6 +32,7 @@ public:
 	/// @return The first body of the manifold
     ////////////////////////////////////////////////////////////
 	RigidBody& getBody0();
+	const RigidBody& getBody0() const;
 
 	////////////////////////////////////////////////////////////
 	/// @brief Get the second body of the manifold
@@ -39,6 +40,7 @@ public:
 	/// @return The second body of the manifold
     ////////////////////////////////////////////////////////////
 	RigidBody& getBody1();
+	const RigidBody& getBody1() const;
 
 	////////////////////////////////////////////////////////////
 	/// @brief Add a contact point to the manifold.
@@ -59,9 +61,9 @@ public:
 	/// 
 	/// @param index The index of the contact point to get.
 	///
-	/// @return The contact point at the specified index.
+	/// @return Reference to the contact point at the specified index.
     ////////////////////////////////////////////////////////////
-	ContactPoint getContactPoint(int index);
+	ContactPoint& getContactPoint(int index);
 
 	////////////////////////////////////////////////////////////
 	/// @brief Get the contact point at the specified index.
@@ -72,6 +74,30 @@ public:
     ////////////////////////////////////////////////////////////
 	const ContactPoint getContactPoint(int index) const;
 
+	////////////////////////////////////////////////////////////
+	/// @brief Reduces the manifold to a small, well spread set
+	/// of contact points.
+	///
+	/// Points closer than mergeDistance to a deeper point are
+	/// dropped. If more than maxContacts points remain, the
+	/// deepest point is kept along with the points that spread
+	/// the manifold out the most.
+	/// 
+	/// @param maxContacts Maximum number of points to keep.
+	/// @param mergeDistance Distance under which two points are 
+	/// considered the same point.
+    ////////////////////////////////////////////////////////////
+	void reduceContacts(unsigned int maxContacts, const Scalar& mergeDistance);
+
+	////////////////////////////////////////////////////////////
+	/// @brief Moves the contact points along with the bodies, 
+	/// using the points' local positions. 
+	///
+	/// Points that have separated are kept, with a negative 
+	/// penetration.
+    ////////////////////////////////////////////////////////////
+	void updateContacts();
+
 private:
 	RigidBody &m_body0;
 	RigidBody &m_body1;
@@ -19,6 +19,12 @@ namespace lt
  */
 struct ContactPoint
 {
+	ContactPoint() : penetration(0), normalImpulse(0) 
+	{
+		tangentImpulse[0] = 0;
+		tangentImpulse[1] = 0;
+	}
+
 	/** The position of the contact in world co-ordinates */
 	Vec3 position;
 
@@ -32,6 +38,29 @@ struct ContactPoint
 	 * the inter-penetrating points. 
 	 */
 	Scalar penetration;
+
+	/** The deepest point of body 1 in body 1's local co-ordinates */
+	Vec3 localPosition0;
+
+	/** The deepest point of body 2 in body 2's local co-ordinates */
+	Vec3 localPosition1;
+
+	/** The contact normal in body 2's local co-ordinates */
+	Vec3 localNormal1;
+
+	/** 
+	 * The total impulse applied along the normal by the 
+	 * contact resolver this update. Never negative, contacts 
+	 * can push the bodies apart but not pull them together.
+	 */
+	Scalar normalImpulse;
+
+	/** 
+	 * The total friction impulse applied along each tangent by
+	 * the contact resolver this update. Never more than the 
+	 * normal impulse times the coefficient of friction.
+	 */
+	Scalar tangentImpulse[2];
 };
 
 } // namespace lt
@@ -1,197 +1,1561 @@
 #include "ContactResolver.hpp"
 
 #include <iostream>
+#include <algorithm>
+#include <climits>
+#include <math.h>
 
 namespace lt
 {
 
-void ContactResolver::resolveContacts(std::vector<ContactManifold> &contactManifolds)
+static const unsigned int NUM_COLOURS = 64; // One per bit of a body's colour mask
+static const unsigned int GROUPS_PER_BATCH = 4; // Groups of bundles of a colour given to a thread at a time
+static const unsigned int BODIES_PER_BATCH = 64; // Bodies given to a thread at a time
+
+static inline unsigned int getIslandSize(const Island &island);
+static inline void gatherVelocities(RigidBody* const bodies[], Scalar vel[3][SIMD_LANES], Scalar angVel[3][SIMD_LANES]);
+static inline void scatterVelocities(RigidBody* const bodies[], const Scalar vel[3][SIMD_LANES], const Scalar angVel[3][SIMD_LANES]);
+static inline void gatherPseudoVelocities(const unsigned int indices[], const std::vector<Vec3> &pushVel, const std::vector<Vec3> &turnVel, Scalar vel[3][SIMD_LANES], Scalar angVel[3][SIMD_LANES]);
+static inline void scatterPseudoVelocities(const unsigned int indices[], std::vector<Vec3> &pushVel, std::vector<Vec3> &turnVel, const Scalar vel[3][SIMD_LANES], const Scalar angVel[3][SIMD_LANES]);
+static inline void tangentBasis(const Vec3 &normal, Vec3 &tangent0, Vec3 &tangent1);
+static inline void applyRowImpulse(const SimdFloat &f, const Scalar dir[3][SIMD_LANES], const Scalar invInertiaAngularA[3][SIMD_LANES], const Scalar invInertiaAngularB[3][SIMD_LANES], 
+	const ContactBundle &bundle, SimdFloat vA[3], SimdFloat wA[3], SimdFloat vB[3], SimdFloat wB[3]);
+static inline void solveLanes(ContactBundle &bundle, const Scalar *target, Scalar *impulse, bool isFrictionSolved, bool isNormalSolved, Scalar velA[3][SIMD_LANES], Scalar angVelA[3][SIMD_LANES], Scalar velB[3][SIMD_LANES], Scalar angVelB[3][SIMD_LANES], SimdFloat &maxImpulseDelta);
+static inline void solveShockLane(ContactBundle &bundle, unsigned int lane, bool isAFrozen, bool isBFrozen);
+static inline void prepareBlock(ContactBlock &block, const ContactBundle *bundles, unsigned int numBundles, unsigned int lane);
+static inline Scalar solveBlock(const ContactBlock &block, ContactBundle *bundles, unsigned int lane);
+
+struct LargerIsland
 {
-	std::list<CollisionResponse> collisionResponseRegistry;
+	const std::vector<Island> *islands;
+	LargerIsland(const std::vector<Island> &islandList) : islands(&islandList) {}
 
-	// Constructs a list of impulses to apply to the rigid bodies
-	for (unsigned int i = 0; i < contactManifolds.size(); i++)
+	bool operator()(unsigned int a, unsigned int b) const
+	{
+		unsigned int sizeA = getIslandSize((*islands)[a]);
+		unsigned int sizeB = getIslandSize((*islands)[b]);
+
+		// Ties keep island order, so the schedule is the same every run
+		return (sizeA != sizeB) ? sizeA > sizeB : a < b;
+	}
+};
+
+ContactResolver::ContactResolver()
+{
+	m_velocityIterations = 10;
+	m_minVelocityIterations = 2;
+	m_velocityTolerance = 0.0001f;
+	m_positionIterations = 4;
+	m_penetrationSlop = 0.005f;
+	m_penetrationCorrection = 0.8f;
+	m_timeStep = 0;
+	m_restitutionThreshold = 0.5f;
+	m_warmStartFactor = 0.85f;
+	m_largeIslandSize = 256;
+	m_isBlockSolverEnabled = false;
+	m_isMassSplittingEnabled = false;
+	m_isShockPropagationEnabled = false;
+
+	setNumThreads(std::thread::hardware_concurrency());
+}
+
+void ContactResolver::resolveContacts(std::vector<Island> &islands, const Scalar& timeStep)
+{
+	m_timeStep = timeStep;
+
+	m_islandOrder.clear();
+	m_largeIslands.clear();
+
+	// Only island size decides how an island is solved, never the number of threads
+	for (unsigned int i = 0; i < islands.size(); i++)
 	{
-		resolveMotion(contactManifolds[i], collisionResponseRegistry);
+		if (islands[i].isAwake && (!islands[i].manifolds.empty() || !islands[i].joints.empty()))
+		{
+			if (getIslandSize(islands[i]) >= m_largeIslandSize)
+			{
+				m_largeIslands.push_back(i);
+			}
+			else
+			{
+				m_islandOrder.push_back(i);
+			}
+		}
 	}
 
-	// Store the collision responses. Velocities aren't modified immediately
-	// because a change in velocity may affect the closing velocity of other collisions.
-	while (!collisionResponseRegistry.empty())
+	// Grown here, the islands' threads only write to it
+	for (unsigned int i = 0; i < m_largeIslands.size(); i++) { fitBodyIndices(islands[m_largeIslands[i]]); }
+	for (unsigned int i = 0; i < m_islandOrder.size(); i++) { fitBodyIndices(islands[m_islandOrder[i]]); }
+
+	if (m_solverData.size() < std::max<size_t>(m_islandOrder.size(), 1))
 	{
-		CollisionResponse &curResponse = collisionResponseRegistry.front();
-		
-		curResponse.body->setVelocity(curResponse.body->getVelocity() + curResponse.changeInVelocity);
-		curResponse.body->setAngularVelocity(curResponse.body->getAngularVelocity() + curResponse.changeInAngularVelocity);
+		m_solverData.resize(std::max<size_t>(m_islandOrder.size(), 1));
+	}
 
-		collisionResponseRegistry.pop_front();
+	// Every thread works on each large island in turn
+	for (unsigned int i = 0; i < m_largeIslands.size(); i++)
+	{
+		resolveLargeIsland(islands[m_largeIslands[i]], m_solverData[0]);
 	}
 
-	resolveAllInterpenetrations(contactManifolds);
+	// Start the largest islands first so the threads finish close together
+	std::sort(m_islandOrder.begin(), m_islandOrder.end(), LargerIsland(islands));
+
+	m_threadPool.run(m_islandOrder.size(), [&](unsigned int i) 
+	{
+		resolveIsland(islands[m_islandOrder[i]], m_solverData[i]);
+	});
+}
+
+void ContactResolver::resolveIsland(Island &island, const Scalar& timeStep)
+{
+	m_timeStep = timeStep;
+
+	if (m_solverData.empty()) { m_solverData.resize(1); }
+	fitBodyIndices(island);
+
+	resolveIsland(island, m_solverData[0]);
 }
 
-void ContactResolver::resolveMotion(ContactManifold& manifold, std::list<CollisionResponse> &collisionResponseRegistry)
+void ContactResolver::setNumThreads(unsigned int numThreads) { m_threadPool.setNumThreads(numThreads); }
+unsigned int ContactResolver::getNumThreads() const { return m_threadPool.getNumThreads(); }
+void ContactResolver::setLargeIslandSize(unsigned int numContacts) { m_largeIslandSize = numContacts; }
+unsigned int ContactResolver::getLargeIslandSize() const { return m_largeIslandSize; }
+void ContactResolver::setIsBlockSolverEnabled(bool isBlockSolverEnabled) { m_isBlockSolverEnabled = isBlockSolverEnabled; }
+bool ContactResolver::isBlockSolverEnabled() const { return m_isBlockSolverEnabled; }
+void ContactResolver::setIsMassSplittingEnabled(bool isMassSplittingEnabled) { m_isMassSplittingEnabled = isMassSplittingEnabled; }
+bool ContactResolver::isMassSplittingEnabled() const { return m_isMassSplittingEnabled; }
+void ContactResolver::setIsShockPropagationEnabled(bool isShockPropagationEnabled) { m_isShockPropagationEnabled = isShockPropagationEnabled; }
+bool ContactResolver::isShockPropagationEnabled() const { return m_isShockPropagationEnabled; }
+void ContactResolver::setPositionIterations(unsigned int iterations) { m_positionIterations = iterations; }
+void ContactResolver::setPenetrationSlop(const Scalar& slop) { m_penetrationSlop = slop; }
+void ContactResolver::setPenetrationCorrection(const Scalar& correction) { m_penetrationCorrection = correction; }
+unsigned int ContactResolver::getPositionIterations() const { return m_positionIterations; }
+const Scalar& ContactResolver::getPenetrationSlop() const { return m_penetrationSlop; }
+const Scalar& ContactResolver::getPenetrationCorrection() const { return m_penetrationCorrection; }
+void ContactResolver::setVelocityIterations(unsigned int iterations) { m_velocityIterations = iterations; }
+void ContactResolver::setMinVelocityIterations(unsigned int iterations) { m_minVelocityIterations = iterations; }
+void ContactResolver::setVelocityTolerance(const Scalar& tolerance) { m_velocityTolerance = tolerance; }
+void ContactResolver::setRestitutionThreshold(const Scalar& threshold) { m_restitutionThreshold = threshold; }
+void ContactResolver::setWarmStartFactor(const Scalar& factor) { m_warmStartFactor = factor; }
+unsigned int ContactResolver::getVelocityIterations() const { return m_velocityIterations; }
+unsigned int ContactResolver::getMinVelocityIterations() const { return m_minVelocityIterations; }
+const Scalar& ContactResolver::getVelocityTolerance() const { return m_velocityTolerance; }
+const Scalar& ContactResolver::getRestitutionThreshold() const { return m_restitutionThreshold; }
+const Scalar& ContactResolver::getWarmStartFactor() const { return m_warmStartFactor; }
+
+//--------------------------
+//	PRIVATES			
+//--------------------------
+
+void ContactResolver::resolveIsland(Island &island, SolverData &data)
 {
-	// Calculate sum of the two inverse masses
-	Scalar totalInvMass = manifold.getBody0().getInvMass() + manifold.getBody1().getInvMass();
+	std::vector<ContactManifold*> &contactManifolds = island.manifolds;
 
-	if(totalInvMass != 0)
+	// Sleeping islands don't move
+	if ((contactManifolds.empty() && island.joints.empty()) || !island.isAwake) { return; }
+
+	prepareBodies(island, data);
+
+	if (m_isMassSplittingEnabled) { splitManifolds(island, data); }
+	else { colourManifolds(island, data); }
+
+	groupManifolds(data, contactManifolds);
+
+	unsigned int numGroups = data.groupBundleStarts.size() - 1;
+
+	prepareBundles(data, contactManifolds, 0, numGroups);
+	warmStart(data, 0, numGroups);
+	averageSplitVelocities(island, data, false, false);
+	prepareJoints(island);
+
+	island.velocityIterations = 0;
+	Scalar impulseDelta = SCALAR_MAX;
+
+	while (!isConverged(island.velocityIterations, impulseDelta))
+	{
+		impulseDelta = solveJoints(island);
+		solveBundles(data, 0, numGroups);
+		averageSplitVelocities(island, data, false, false);
+
+		impulseDelta = std::max(impulseDelta, largestImpulseDelta(data));
+		island.velocityIterations++;
+	}
+
+	if (m_isShockPropagationEnabled) { propagateShock(island, data); }
+
+	storeImpulses(data, 0, numGroups);
+
+	for (unsigned int i = 0; i < m_positionIterations; i++)
 	{
-		// Apply the impulse.
-		calcImpulse(manifold, collisionResponseRegistry);
+		solvePushJoints(island, data);
+		solvePushBundles(data, 0, numGroups);
+		averageSplitVelocities(island, data, true, false);
 	}
+
+	applyPseudoVelocities(island, data, 0, island.bodies.size());
 }
 
-void ContactResolver::calcImpulse(ContactManifold& manifold, std::list<CollisionResponse> &collisionResponseRegistry)
+void ContactResolver::resolveLargeIsland(Island &island, SolverData &data)
 {
-	// Get the two bodies
-	RigidBody& A = manifold.getBody0(); 
-	RigidBody& B = manifold.getBody1(); 
+	std::vector<ContactManifold*> &contactManifolds = island.manifolds;
+
+	prepareBodies(island, data);
+
+	if (m_isMassSplittingEnabled) { splitManifolds(island, data); }
+	else { colourManifolds(island, data); }
 
-	// Calculate restitution of collision;
-	Scalar restitution = A.getRestitution() * B.getRestitution();
+	// Each group only writes to its own bundles, any split will do
+	groupManifolds(data, contactManifolds);
 
-	// Collision responses
-	CollisionResponse responseOfBodyA;
-	CollisionResponse responseOfBodyB;
+	unsigned int numGroups = data.groupBundleStarts.size() - 1;
+	unsigned int numBatches = (numGroups + GROUPS_PER_BATCH - 1) / GROUPS_PER_BATCH;
 
-	responseOfBodyA.body = &A;
-	responseOfBodyB.body = &B;
+	m_threadPool.run(numBatches, [&](unsigned int i)
+	{
+		unsigned int firstGroup = i * GROUPS_PER_BATCH;
+		prepareBundles(data, contactManifolds, firstGroup, std::min(firstGroup + GROUPS_PER_BATCH, numGroups));
+	});
 
+	solveGroupColours(data, &ContactResolver::warmStart);
+	averageSplitVelocities(island, data, false, true);
+	prepareJoints(island);
 
-	int numContacts = manifold.getNumContacts();
+	island.velocityIterations = 0;
+	Scalar impulseDelta = SCALAR_MAX;
 
-	for(int i = 0 ; i < numContacts; i++)
+	while (!isConverged(island.velocityIterations, impulseDelta))
 	{
-		ContactPoint &pt = manifold.getContactPoint(i);
+		// Joints can share bodies with any colour, so they're solved between colours
+		impulseDelta = solveJoints(island);
+		solveGroupColours(data, &ContactResolver::solveBundles);
+		averageSplitVelocities(island, data, false, true);
+
+		impulseDelta = std::max(impulseDelta, largestImpulseDelta(data));
+		island.velocityIterations++;
+	}
+
+	// Each layer rests on the one below, so this pass can't be split
+	if (m_isShockPropagationEnabled) { propagateShock(island, data); }
 
-		Vec3 contactPos = pt.position;
-		Vec3 contactPosA = contactPos - A.getPosition();
-		Vec3 contactPosB = contactPos - B.getPosition();
+	m_threadPool.run(numBatches, [&](unsigned int i)
+	{
+		unsigned int firstGroup = i * GROUPS_PER_BATCH;
+		storeImpulses(data, firstGroup, std::min(firstGroup + GROUPS_PER_BATCH, numGroups));
+	});
 
-		Vec3 normal = pt.normal;
+	for (unsigned int i = 0; i < m_positionIterations; i++)
+	{
+		solvePushJoints(island, data);
+		solveGroupColours(data, &ContactResolver::solvePushBundles);
+		averageSplitVelocities(island, data, true, true);
+	}
 
-		Vec3 kA = contactPosA.cross(normal); // Temp variable to store reused equation
-		Vec3 kB = contactPosB.cross(normal); // Temp variable to store reused equation
-		Vec3 uA = A.getInvInertiaTensorWorld() * kA; // Temp variable to store reused equation
-		Vec3 uB = B.getInvInertiaTensorWorld() * kB; // Temp variable to store reused equation
+	// Each body is only moved by its own pseudo velocity, any split will do
+	unsigned int numBodies = island.bodies.size();
+	numBatches = (numBodies + BODIES_PER_BATCH - 1) / BODIES_PER_BATCH;
 
-		// Calculate the numerator and denominator for the impulse equation. 
-		Scalar numer = -(1 + restitution) * (
-				normal.dot(A.getVelocity() - B.getVelocity()) + // Linear closing velocity
-				A.getAngularVelocity().dot(kA) - // Rotational closing velocity of body A.
-				B.getAngularVelocity().dot(kB)   // Rotational closing velocity of body B.
-			);
-		
-		Scalar denom = A.getInvMass() + B.getInvMass() + 
-				kA.dot(uA) + kB.dot(uB);
+	m_threadPool.run(numBatches, [&](unsigned int i)
+	{
+		unsigned int begin = i * BODIES_PER_BATCH;
+		applyPseudoVelocities(island, data, begin, std::min(begin + BODIES_PER_BATCH, numBodies));
+	});
+}
 
-		Scalar f = numer/(denom*(Scalar)numContacts); 
-		Vec3 impulse = normal * f;
+void ContactResolver::fitBodyIndices(const Island &island)
+{
+	for (unsigned int i = 0; i < island.bodies.size(); i++)
+	{
+		unsigned int index = island.bodies[i]->getWorldIndex();
 
-		responseOfBodyA.changeInVelocity += impulse * A.getInvMass();
-		responseOfBodyB.changeInVelocity += -impulse * B.getInvMass();
-	
-		responseOfBodyA.changeInAngularVelocity += uA * f;
-		responseOfBodyB.changeInAngularVelocity += -uB * f;
-	
-		
+		if (index >= m_bodyIndices.size()) { m_bodyIndices.resize(index + 1); }
 	}
-	
-	collisionResponseRegistry.push_back(responseOfBodyA);
-	collisionResponseRegistry.push_back(responseOfBodyB);
 }
 
-void ContactResolver::resolveAllInterpenetrations(std::vector<ContactManifold> &contactManifolds)
+void ContactResolver::prepareBodies(Island &island, SolverData &data)
 {
-	for (unsigned int i = 0; i < contactManifolds.size(); i++)
+	unsigned int numBodies = island.bodies.size();
+
+	for (unsigned int i = 0; i < numBodies; i++)
 	{
-		resolveInterpenetration(contactManifolds[i]);
+		m_bodyIndices[island.bodies[i]->getWorldIndex()] = i;
 	}
+
+	// The extra entry stands in for static bodies, it's never written to
+	data.pushVelocities.assign(numBodies + 1, Vec3(0, 0, 0));
+	data.turnVelocities.assign(numBodies + 1, Vec3(0, 0, 0));
 }
 
-void ContactResolver::resolveInterpenetration(ContactManifold& manifold)
+void ContactResolver::colourManifolds(Island &island, SolverData &data)
 {
-	// Get the two bodies
-	RigidBody* bodies[2];
-	bodies[0] = &manifold.getBody0(); 
-	bodies[1] = &manifold.getBody1(); 
+	std::vector<ContactManifold*> &contactManifolds = island.manifolds;
 
-	int numContacts = manifold.getNumContacts();
+	// By index in the island, so small islands stay small in big worlds
+	data.bodyColours.assign(island.bodies.size(), 0);
 
-	for(int j = 0 ; j < numContacts; j++)
+	data.manifoldColours.resize(contactManifolds.size());
+	data.colourStarts.assign(NUM_COLOURS + 2, 0);
+
+	// Greedily give each manifold the first colour neither of its dynamic bodies has used.
+	// Manifolds left over once a body runs out of colours go in a last colour solved by one thread.
+	for (unsigned int i = 0; i < contactManifolds.size(); i++)
 	{
-		Scalar totalInertia = 0;
-		Scalar angularInertia[2];
-		Scalar linearInertia[2];
-		Scalar angularMove[2];
-		Vec3 angleChange[2];
-		Scalar linearMove[2];
-		Vec3 positionChange[2];
-		Vec3 relativeContactPosition[2];
+		const RigidBody &A = contactManifolds[i]->getBody0();
+		const RigidBody &B = contactManifolds[i]->getBody1();
 
-		ContactPoint &pt = manifold.getContactPoint(j);
-		Vec3 contactPos = pt.position;
-		Vec3 normal = pt.normal;
+		unsigned long long *coloursA = (A.getInvMass() != 0) ? &data.bodyColours[m_bodyIndices[A.getWorldIndex()]] : nullptr;
+		unsigned long long *coloursB = (B.getInvMass() != 0) ? &data.bodyColours[m_bodyIndices[B.getWorldIndex()]] : nullptr;
 
-		for(unsigned int i = 0; i < 2; i++) 
+		unsigned long long used = 0;
+		if (coloursA) { used |= *coloursA; }
+		if (coloursB) { used |= *coloursB; }
+
+		unsigned int colour = 0;
+		while (colour < NUM_COLOURS && (used & (1ULL << colour))) { colour++; }
+
+		if (colour < NUM_COLOURS)
 		{
-			if(bodies[i])
-			{
-				Mat3 inverseInertiaTensor = bodies[i]->getInvInertiaTensorWorld();
-			
-				relativeContactPosition[i] = contactPos - bodies[i]->getPosition();
+			if (coloursA) { *coloursA |= 1ULL << colour; }
+			if (coloursB) { *coloursB |= 1ULL << colour; }
+		}
+
+		data.manifoldColours[i] = colour;
+		data.colourStarts[colour + 1]++;
+	}
+
+	// Sort the manifolds by colour, keeping their order within each colour
+	for (unsigned int i = 1; i < data.colourStarts.size(); i++)
+	{
+		data.colourStarts[i] += data.colourStarts[i - 1];
+	}
+
+	data.colouredManifolds.resize(contactManifolds.size());
+	std::vector<unsigned int> next(data.colourStarts.begin(), data.colourStarts.end() - 1);
+
+	for (unsigned int i = 0; i < contactManifolds.size(); i++)
+	{
+		data.colouredManifolds[next[data.manifoldColours[i]]++] = contactManifolds[i];
+	}
+
+	contactManifolds.swap(data.colouredManifolds);
+}
+
+void ContactResolver::splitManifolds(Island &island, SolverData &data)
+{
+	std::vector<ContactManifold*> &contactManifolds = island.manifolds;
+
+	unsigned int numManifolds = contactManifolds.size();
+	unsigned int numBodies = island.bodies.size();
+
+	// Every manifold has its own copy of its bodies' velocities, so they can all go in the first colour
+	data.colourStarts.assign(NUM_COLOURS + 2, numManifolds);
+	data.colourStarts[0] = 0;
+
+	// Copy 2i is manifold i's body 1, copy 2i + 1 its body 2
+	data.splitVelocities.assign(numManifolds * 2 + 1, Vec3(0, 0, 0));
+	data.splitAngularVelocities.assign(numManifolds * 2 + 1, Vec3(0, 0, 0));
+
+	// List each dynamic body's copies, in manifold order so they're always averaged in the same order
+	data.bodySlotStarts.assign(numBodies + 1, 0);
+
+	for (unsigned int i = 0; i < numManifolds; i++)
+	{
+		const RigidBody &A = contactManifolds[i]->getBody0();
+		const RigidBody &B = contactManifolds[i]->getBody1();
+
+		if (A.getInvMass() != 0) { data.bodySlotStarts[m_bodyIndices[A.getWorldIndex()] + 1]++; }
+		if (B.getInvMass() != 0) { data.bodySlotStarts[m_bodyIndices[B.getWorldIndex()] + 1]++; }
+	}
+
+	for (unsigned int i = 1; i <= numBodies; i++)
+	{
+		data.bodySlotStarts[i] += data.bodySlotStarts[i - 1];
+	}
+
+	data.bodySlots.resize(data.bodySlotStarts[numBodies]);
+	std::vector<unsigned int> next(data.bodySlotStarts.begin(), data.bodySlotStarts.end() - 1);
+
+	for (unsigned int i = 0; i < numManifolds; i++)
+	{
+		const RigidBody &A = contactManifolds[i]->getBody0();
+		const RigidBody &B = contactManifolds[i]->getBody1();
 
-				Vec3 angularInertiaWorld = relativeContactPosition[i].cross(normal);
-				angularInertiaWorld = inverseInertiaTensor * angularInertiaWorld;
-				angularInertiaWorld = angularInertiaWorld.cross(relativeContactPosition[i]);
-				angularInertia[i] = angularInertiaWorld.dot(normal);
+		if (A.getInvMass() != 0) { data.bodySlots[next[m_bodyIndices[A.getWorldIndex()]]++] = i * 2; }
+		if (B.getInvMass() != 0) { data.bodySlots[next[m_bodyIndices[B.getWorldIndex()]]++] = i * 2 + 1; }
+	}
+}
+
+void ContactResolver::groupManifolds(SolverData &data, std::vector<ContactManifold*> &contactManifolds)
+{
+	data.colourGroupStarts.resize(NUM_COLOURS + 2);
+	data.groupManifoldStarts.clear();
+	data.groupBundleStarts.clear();
+
+	unsigned int numBundles = 0;
+
+	for (unsigned int colour = 0; colour <= NUM_COLOURS; colour++)
+	{
+		data.colourGroupStarts[colour] = data.groupManifoldStarts.size();
+
+		// The left over colour can share bodies, so its manifolds can't share bundles
+		unsigned int groupSize = (colour < NUM_COLOURS) ? SIMD_LANES : 1;
+		unsigned int colourEnd = data.colourStarts[colour + 1];
 
-				linearInertia[i] = bodies[i]->getInvMass();
+		for (unsigned int i = data.colourStarts[colour]; i < colourEnd; i += groupSize)
+		{
+			data.groupManifoldStarts.push_back(i);
+			data.groupBundleStarts.push_back(numBundles);
+
+			// A bundle for each contact index of the group's manifolds
+			int maxContacts = 0;
 
-				totalInertia += linearInertia[i] + angularInertia[i];
+			for (unsigned int j = i; j < std::min(i + groupSize, colourEnd); j++)
+			{
+				maxContacts = std::max(maxContacts, contactManifolds[j]->getNumContacts());
 			}
+
+			numBundles += maxContacts;
 		}
+	}
+
+	data.colourGroupStarts[NUM_COLOURS + 1] = data.groupManifoldStarts.size();
+	data.groupManifoldStarts.push_back(contactManifolds.size());
+	data.groupBundleStarts.push_back(numBundles);
+
+	data.bundles.resize(numBundles);
+
+	data.groupImpulseDeltas.resize(data.groupBundleStarts.size() - 1);
+
+	if (isBlockSolverUsed())
+	{
+		data.blocks.resize((data.groupBundleStarts.size() - 1) * SIMD_LANES);
+	}
+}
+
+void ContactResolver::solveGroupColours(SolverData &data, GroupFunction function)
+{
+	for (unsigned int colour = 0; colour <= NUM_COLOURS; colour++)
+	{
+		unsigned int colourBegin = data.colourGroupStarts[colour];
+		unsigned int colourEnd = data.colourGroupStarts[colour + 1];
+
+		if (colourBegin == colourEnd) { continue; }
+
+		// The left over colour can share bodies, so it isn't split
+		unsigned int batchSize = (colour < NUM_COLOURS) ? GROUPS_PER_BATCH : colourEnd - colourBegin;
+		unsigned int numBatches = (colourEnd - colourBegin + batchSize - 1) / batchSize;
+
+		m_threadPool.run(numBatches, [&](unsigned int i)
+		{
+			unsigned int firstGroup = colourBegin + i * batchSize;
+			(this->*function)(data, firstGroup, std::min(firstGroup + batchSize, colourEnd));
+		});
+	}
+}
+
+void ContactResolver::prepareJoints(Island &island)
+{
+	for (unsigned int i = 0; i < island.joints.size(); i++)
+	{
+		island.joints[i]->prepare(m_timeStep, m_warmStartFactor);
+	}
+}
+
+Scalar ContactResolver::solveJoints(Island &island)
+{
+	Scalar maxDelta = 0;
+
+	for (unsigned int i = 0; i < island.joints.size(); i++)
+	{
+		maxDelta = std::max(maxDelta, island.joints[i]->solveVelocities());
+	}
+
+	return maxDelta;
+}
+
+void ContactResolver::solvePushJoints(Island &island, SolverData &data)
+{
+	unsigned int staticIndex = data.pushVelocities.size() - 1;
+
+	for (unsigned int i = 0; i < island.joints.size(); i++)
+	{
+		const RigidBody &A = island.joints[i]->getBody0();
+		const RigidBody &B = island.joints[i]->getBody1();
+
+		unsigned int indexA = (A.getInvMass() != 0) ? m_bodyIndices[A.getWorldIndex()] : staticIndex;
+		unsigned int indexB = (B.getInvMass() != 0) ? m_bodyIndices[B.getWorldIndex()] : staticIndex;
+
+		island.joints[i]->solvePushVelocities(data.pushVelocities[indexA], data.turnVelocities[indexA], data.pushVelocities[indexB], data.turnVelocities[indexB]);
+	}
+}
+
+void ContactResolver::prepareBundles(SolverData &data, std::vector<ContactManifold*> &contactManifolds, unsigned int firstGroup, unsigned int endGroup)
+{
+	for (unsigned int group = firstGroup; group < endGroup; group++)
+	{
+		unsigned int firstManifold = data.groupManifoldStarts[group];
+		unsigned int numManifolds = data.groupManifoldStarts[group + 1] - firstManifold;
+		unsigned int firstBundle = data.groupBundleStarts[group];
+		unsigned int numBundles = data.groupBundleStarts[group + 1] - firstBundle;
 
-		if(totalInertia > 0) 
+		unsigned int staticIndex = data.pushVelocities.size() - 1;
+		unsigned int emptySlot = contactManifolds.size() * 2;
+
+		// Everything the iterations need is worked out once here, they only read the bundles
+		// Bundle j holds the j'th contact of each of the group's manifolds
+		for (unsigned int j = 0; j < numBundles; j++)
 		{
-			// Calculate linear and angular movement.
-			Scalar inverseInertia = 1 / totalInertia;
-			linearMove[0] = pt.penetration * linearInertia[0] * inverseInertia / numContacts;
-			linearMove[1] = -pt.penetration * linearInertia[1] * inverseInertia / numContacts;
-			angularMove[0] =  pt.penetration * angularInertia[0] * inverseInertia / numContacts;
-			angularMove[1] = -pt.penetration * angularInertia[1] * inverseInertia / numContacts;
+			ContactBundle &bundle = data.bundles[firstBundle + j];
 
-			for(unsigned int i = 0; i < 2; i++)
+			for (unsigned int lane = 0; lane < SIMD_LANES; lane++)
 			{
-				if(bodies[i])
+				ContactManifold *manifold = (lane < numManifolds) ? contactManifolds[firstManifold + lane] : nullptr;
+
+				// Empty lanes never apply an impulse
+				if (!manifold || (int)j >= manifold->getNumContacts())
+				{
+					for (unsigned int k = 0; k < 3; k++)
+					{
+						bundle.normal[k][lane] = 0;
+						bundle.angularA[k][lane] = 0;
+						bundle.angularB[k][lane] = 0;
+						bundle.invInertiaAngularA[k][lane] = 0;
+						bundle.invInertiaAngularB[k][lane] = 0;
+					}
+
+					bundle.invMassA[lane] = 0;
+					bundle.invMassB[lane] = 0;
+					bundle.effectiveMass[lane] = 0;
+					bundle.targetVelocity[lane] = 0;
+					bundle.normalImpulse[lane] = 0;
+					for (unsigned int t = 0; t < 2; t++)
+					{
+						for (unsigned int k = 0; k < 3; k++)
+						{
+							bundle.tangent[t][k][lane] = 0;
+							bundle.tangentAngularA[t][k][lane] = 0;
+							bundle.tangentAngularB[t][k][lane] = 0;
+							bundle.tangentInvInertiaAngularA[t][k][lane] = 0;
+							bundle.tangentInvInertiaAngularB[t][k][lane] = 0;
+						}
+
+						bundle.tangentEffectiveMass[t][lane] = 0;
+						bundle.tangentImpulse[t][lane] = 0;
+					}
+
+					bundle.friction[lane] = 0;
+					bundle.penetrationBias[lane] = 0;
+					bundle.pushImpulse[lane] = 0;
+					bundle.indexA[lane] = staticIndex;
+					bundle.indexB[lane] = staticIndex;
+					bundle.slotA[lane] = emptySlot;
+					bundle.slotB[lane] = emptySlot;
+					bundle.bodyA[lane] = nullptr;
+					bundle.bodyB[lane] = nullptr;
+					bundle.contacts[lane] = nullptr;
+					continue;
+				}
+
+				RigidBody& A = manifold->getBody0(); 
+				RigidBody& B = manifold->getBody1(); 
+				ContactPoint &pt = manifold->getContactPoint(j);
+
+				Vec3 rA = pt.position - A.getPosition();
+				Vec3 rB = pt.position - B.getPosition();
+
+				// With mass splitting each manifold only gets its share of a body's mass
+				Scalar splitA = 1, splitB = 1;
+
+				if (m_isMassSplittingEnabled && A.getInvMass() != 0)
+				{
+					unsigned int index = m_bodyIndices[A.getWorldIndex()];
+					splitA = (Scalar)(data.bodySlotStarts[index + 1] - data.bodySlotStarts[index]);
+				}
+
+				if (m_isMassSplittingEnabled && B.getInvMass() != 0)
+				{
+					unsigned int index = m_bodyIndices[B.getWorldIndex()];
+					splitB = (Scalar)(data.bodySlotStarts[index + 1] - data.bodySlotStarts[index]);
+				}
+
+				Scalar invMassA = A.getInvMass() * splitA;
+				Scalar invMassB = B.getInvMass() * splitB;
+				const Mat3 &invInertiaA = A.getInvInertiaTensorWorld();
+				const Mat3 &invInertiaB = B.getInvInertiaTensorWorld();
+
+				Vec3 kA = rA.cross(pt.normal);
+				Vec3 kB = rB.cross(pt.normal);
+				Vec3 uA = (invInertiaA * kA) * splitA;
+				Vec3 uB = (invInertiaB * kB) * splitB;
+
+				Scalar denom = invMassA + invMassB + kA.dot(uA) + kB.dot(uB);
+
+				Scalar targetVelocity;
+
+				if (pt.penetration < 0)
+				{
+					// Still apart, the bodies may close the gap this update but no further
+					targetVelocity = pt.penetration / m_timeStep;
+				}
+				else
+				{
+					// Bounce off with the closing velocity from before any impulses were applied
+					Scalar restitution = A.getRestitution() * B.getRestitution();
+					Scalar vn = pt.normal.dot(A.getVelocity() - B.getVelocity()) + kA.dot(A.getAngularVelocity()) - kB.dot(B.getAngularVelocity());
+
+					targetVelocity = (vn < -m_restitutionThreshold) ? -restitution * vn : 0;
+				}
+
+				// Start from a portion of last update's impulses, friction only carries over while the contact pushes
+				Scalar normalImpulse = pt.normalImpulse * m_warmStartFactor;
+				Scalar frictionWarmStart = (normalImpulse != 0) ? m_warmStartFactor : 0;
+
+				Vec3 tangents[2];
+				tangentBasis(pt.normal, tangents[0], tangents[1]);
+
+				const Scalar normal[3] = { pt.normal.x, pt.normal.y, pt.normal.z };
+				const Scalar angularA[3] = { kA.x, kA.y, kA.z };
+				const Scalar angularB[3] = { kB.x, kB.y, kB.z };
+				const Scalar invInertiaAngularA[3] = { uA.x, uA.y, uA.z };
+				const Scalar invInertiaAngularB[3] = { uB.x, uB.y, uB.z };
+
+				for (unsigned int k = 0; k < 3; k++)
+				{
+					bundle.normal[k][lane] = normal[k];
+					bundle.angularA[k][lane] = angularA[k];
+					bundle.angularB[k][lane] = angularB[k];
+					bundle.invInertiaAngularA[k][lane] = invInertiaAngularA[k];
+					bundle.invInertiaAngularB[k][lane] = invInertiaAngularB[k];
+				}
+
+				bundle.invMassA[lane] = invMassA;
+				bundle.invMassB[lane] = invMassB;
+				bundle.effectiveMass[lane] = (denom > 0) ? 1 / denom : 0;
+				bundle.targetVelocity[lane] = targetVelocity;
+				bundle.normalImpulse[lane] = normalImpulse;
+
+				for (unsigned int t = 0; t < 2; t++)
 				{
-					// Apply linear movement
-					positionChange[i] = normal * linearMove[i];
-					bodies[i]->setPosition(positionChange[i] + bodies[i]->getPosition());
+					const Vec3 &tangent = tangents[t];
+
+					Vec3 tkA = rA.cross(tangent);
+					Vec3 tkB = rB.cross(tangent);
+					Vec3 tuA = (invInertiaA * tkA) * splitA;
+					Vec3 tuB = (invInertiaB * tkB) * splitB;
+
+					Scalar tangentDenom = invMassA + invMassB + tkA.dot(tuA) + tkB.dot(tuB);
 
-					if(angularMove[i] != 0)
+					const Scalar tangentRow[3] = { tangent.x, tangent.y, tangent.z };
+					const Scalar tangentAngularA[3] = { tkA.x, tkA.y, tkA.z };
+					const Scalar tangentAngularB[3] = { tkB.x, tkB.y, tkB.z };
+					const Scalar tangentInvInertiaAngularA[3] = { tuA.x, tuA.y, tuA.z };
+					const Scalar tangentInvInertiaAngularB[3] = { tuB.x, tuB.y, tuB.z };
+
+					for (unsigned int k = 0; k < 3; k++)
 					{
-						// Calculate the torque required to move the relative contact position 1 unit.
-						const Mat3 &inverseInertiaTensor = bodies[i]->getInvInertiaTensorWorld();
-						Vec3 impulsiveTorque = relativeContactPosition[i].cross(normal);
-						Vec3 impulsePerMove = inverseInertiaTensor * impulsiveTorque;
-
-						Vec3 rotationPerMove = impulsePerMove * 1/angularInertia[i];
-						angleChange[i] = Vec3(0, 0, 0);//rotationPerMove * angularMove[i];
-				
-						// Apply angular movement
-						Quat newAngle = bodies[i]->getAngle();
-						newAngle = Quat(Vec3(1.0f, 0.0f, 0.0f), angleChange[i].x) * newAngle;
-						newAngle = Quat(Vec3(0.0f, 1.0f, 0.0f), angleChange[i].y) * newAngle;
-						newAngle = Quat(Vec3(0.0f, 0.0f, 1.0f), angleChange[i].z) * newAngle;
-
-						bodies[i]->setAngle(newAngle);
+						bundle.tangent[t][k][lane] = tangentRow[k];
+						bundle.tangentAngularA[t][k][lane] = tangentAngularA[k];
+						bundle.tangentAngularB[t][k][lane] = tangentAngularB[k];
+						bundle.tangentInvInertiaAngularA[t][k][lane] = tangentInvInertiaAngularA[k];
+						bundle.tangentInvInertiaAngularB[t][k][lane] = tangentInvInertiaAngularB[k];
 					}
+
+					bundle.tangentEffectiveMass[t][lane] = (tangentDenom > 0) ? 1 / tangentDenom : 0;
+					bundle.tangentImpulse[t][lane] = pt.tangentImpulse[t] * frictionWarmStart;
 				}
+
+				bundle.friction[lane] = scalar_sqrt(A.getFriction() * B.getFriction());
+				bundle.penetrationBias[lane] = (pt.penetration > m_penetrationSlop) ? (pt.penetration - m_penetrationSlop) * m_penetrationCorrection / m_timeStep : 0;
+				bundle.pushImpulse[lane] = 0;
+				bundle.indexA[lane] = (A.getInvMass() != 0) ? m_bodyIndices[A.getWorldIndex()] : staticIndex;
+				bundle.indexB[lane] = (B.getInvMass() != 0) ? m_bodyIndices[B.getWorldIndex()] : staticIndex;
+				bundle.slotA[lane] = (firstManifold + lane) * 2;
+				bundle.slotB[lane] = (firstManifold + lane) * 2 + 1;
+				bundle.bodyA[lane] = &A;
+				bundle.bodyB[lane] = &B;
+				bundle.contacts[lane] = &pt;
+			}
+		}
+
+		if (isBlockSolverUsed() && numBundles >= 2)
+		{
+			for (unsigned int lane = 0; lane < SIMD_LANES; lane++)
+			{
+				prepareBlock(data.blocks[group * SIMD_LANES + lane], &data.bundles[firstBundle], numBundles, lane);
+			}
+		}
+	}
+}
+
+void ContactResolver::warmStart(SolverData &data, unsigned int firstGroup, unsigned int endGroup)
+{
+	Scalar velA[3][SIMD_LANES], angVelA[3][SIMD_LANES];
+	Scalar velB[3][SIMD_LANES], angVelB[3][SIMD_LANES];
+	SimdFloat vA[3], wA[3], vB[3], wB[3];
+
+	unsigned int endBundle = data.groupBundleStarts[endGroup];
+
+	loadSplitVelocities(data, firstGroup, endGroup, false);
+
+	// Apply the impulses the bundles start from, along the prepared jacobians
+	for (unsigned int i = data.groupBundleStarts[firstGroup]; i < endBundle; i++)
+	{
+		ContactBundle &bundle = data.bundles[i];
+
+		gatherBundle(data, bundle, false, velA, angVelA, velB, angVelB);
+
+		for (unsigned int k = 0; k < 3; k++)
+		{
+			vA[k] = SimdFloat::load(velA[k]);
+			wA[k] = SimdFloat::load(angVelA[k]);
+			vB[k] = SimdFloat::load(velB[k]);
+			wB[k] = SimdFloat::load(angVelB[k]);
+		}
+
+		applyRowImpulse(SimdFloat::load(bundle.normalImpulse), bundle.normal, bundle.invInertiaAngularA, bundle.invInertiaAngularB, bundle, vA, wA, vB, wB);
+
+		for (unsigned int t = 0; t < 2; t++)
+		{
+			applyRowImpulse(SimdFloat::load(bundle.tangentImpulse[t]), bundle.tangent[t], bundle.tangentInvInertiaAngularA[t], bundle.tangentInvInertiaAngularB[t], bundle, vA, wA, vB, wB);
+		}
+
+		for (unsigned int k = 0; k < 3; k++)
+		{
+			vA[k].store(velA[k]);
+			wA[k].store(angVelA[k]);
+			vB[k].store(velB[k]);
+			wB[k].store(angVelB[k]);
+		}
+
+		scatterBundle(data, bundle, false, velA, angVelA, velB, angVelB);
+	}
+}
+
+void ContactResolver::solveBundles(SolverData &data, unsigned int firstGroup, unsigned int endGroup)
+{
+	Scalar velA[3][SIMD_LANES], angVelA[3][SIMD_LANES];
+	Scalar velB[3][SIMD_LANES], angVelB[3][SIMD_LANES];
+
+	for (unsigned int group = firstGroup; group < endGroup; group++)
+	{
+		unsigned int firstBundle = data.groupBundleStarts[group];
+		unsigned int endBundle = data.groupBundleStarts[group + 1];
+		unsigned int numBundles = endBundle - firstBundle;
+
+		// Each lane is solved the same whatever else shares its group, so the result doesn't depend on SIMD_LANES
+		bool isBlockSolved = isBlockSolverUsed() && numBundles >= 2;
+
+		SimdFloat laneDeltas(0.0f);
+		Scalar maxDelta = 0;
+
+		loadSplitVelocities(data, group, group + 1, false);
+
+		for (unsigned int i = firstBundle; i < endBundle; i++)
+		{
+			ContactBundle &bundle = data.bundles[i];
+
+			gatherBundle(data, bundle, false, velA, angVelA, velB, angVelB);
+
+			solveLanes(bundle, bundle.targetVelocity, bundle.normalImpulse, true, !isBlockSolved, velA, angVelA, velB, angVelB, laneDeltas);
+
+			scatterBundle(data, bundle, false, velA, angVelA, velB, angVelB);
+		}
+
+		// Then the normal impulses of each manifold together
+		if (isBlockSolved)
+		{
+			for (unsigned int lane = 0; lane < SIMD_LANES; lane++)
+			{
+				maxDelta = std::max(maxDelta, solveBlock(data.blocks[group * SIMD_LANES + lane], &data.bundles[firstBundle], lane));
 			}
 		}
+
+		Scalar deltas[SIMD_LANES];
+		laneDeltas.store(deltas);
+
+		for (unsigned int lane = 0; lane < SIMD_LANES; lane++)
+		{
+			maxDelta = std::max(maxDelta, deltas[lane]);
+		}
+
+		data.groupImpulseDeltas[group] = maxDelta;
+	}
+}
+
+Scalar ContactResolver::largestImpulseDelta(SolverData &data)
+{
+	Scalar maxDelta = 0;
+
+	for (unsigned int i = 0; i < data.groupImpulseDeltas.size(); i++)
+	{
+		maxDelta = std::max(maxDelta, data.groupImpulseDeltas[i]);
 	}
+
+	return maxDelta;
+}
+
+bool ContactResolver::isConverged(unsigned int iterations, const Scalar &impulseDelta) const
+{
+	if (iterations >= m_velocityIterations) { return true; }
+	if (iterations < m_minVelocityIterations) { return false; }
+
+	return impulseDelta < m_velocityTolerance;
+}
+
+void ContactResolver::storeImpulses(SolverData &data, unsigned int firstGroup, unsigned int endGroup)
+{
+	unsigned int endBundle = data.groupBundleStarts[endGroup];
+
+	// Keep the impulses on the contacts for warm starting
+	for (unsigned int i = data.groupBundleStarts[firstGroup]; i < endBundle; i++)
+	{
+		ContactBundle &bundle = data.bundles[i];
+
+		for (unsigned int lane = 0; lane < SIMD_LANES; lane++)
+		{
+			if (bundle.contacts[lane])
+			{
+				bundle.contacts[lane]->normalImpulse = bundle.normalImpulse[lane];
+				bundle.contacts[lane]->tangentImpulse[0] = bundle.tangentImpulse[0][lane];
+				bundle.contacts[lane]->tangentImpulse[1] = bundle.tangentImpulse[1][lane];
+			}
+		}
+	}
+}
+
+void ContactResolver::solvePushBundles(SolverData &data, unsigned int firstGroup, unsigned int endGroup)
+{
+	Scalar velA[3][SIMD_LANES], angVelA[3][SIMD_LANES];
+	Scalar velB[3][SIMD_LANES], angVelB[3][SIMD_LANES];
+	SimdFloat pushDeltas(0.0f);
+
+	unsigned int endBundle = data.groupBundleStarts[endGroup];
+
+	loadSplitVelocities(data, firstGroup, endGroup, true);
+
+	// Same as the velocity solve, but on the pseudo velocities, aiming to push the bodies apart
+	for (unsigned int i = data.groupBundleStarts[firstGroup]; i < endBundle; i++)
+	{
+		ContactBundle &bundle = data.bundles[i];
+
+		gatherBundle(data, bundle, true, velA, angVelA, velB, angVelB);
+
+		solveLanes(bundle, bundle.penetrationBias, bundle.pushImpulse, false, true, velA, angVelA, velB, angVelB, pushDeltas);
+
+		scatterBundle(data, bundle, true, velA, angVelA, velB, angVelB);
+	}
+}
+
+void ContactResolver::applyPseudoVelocities(Island &island, SolverData &data, unsigned int begin, unsigned int end)
+{
+	const Scalar RAD_TO_DEG = 57.2957795f;
+
+	for (unsigned int i = begin; i < end; i++)
+	{
+		const Vec3 &push = data.pushVelocities[i];
+		const Vec3 &turn = data.turnVelocities[i];
+
+		if (push.dot(push) == 0 && turn.dot(turn) == 0) { continue; }
+
+		RigidBody &body = *island.bodies[i];
+
+		Vec3 position = body.getPosition() + push * m_timeStep;
+		Quat angle = body.getAngle();
+
+		Scalar turnSpeed = turn.length();
+
+		if (turnSpeed > 0)
+		{
+			angle = Quat(turn * (1 / turnSpeed), turnSpeed * m_timeStep * RAD_TO_DEG) * angle;
+			angle.normalize();
+		}
+
+		// Moves the body, its derived data is worked out once when next read
+		body.setPositionAndAngle(position, angle);
+	}
+}
+
+void ContactResolver::propagateShock(Island &island, SolverData &data)
+{
+	std::vector<ContactManifold*> &contactManifolds = island.manifolds;
+
+	unsigned int numBodies = island.bodies.size();
+	unsigned int numManifolds = contactManifolds.size();
+
+	// Static bodies are layer 0, a body touching one is layer 1 and so on. 
+	// Bodies that don't rest on anything static keep UINT_MAX.
+	data.bodyLayers.assign(numBodies, UINT_MAX);
+	bool isChanged = true;
+
+	while (isChanged)
+	{
+		isChanged = false;
+
+		for (unsigned int i = 0; i < numManifolds; i++)
+		{
+			const RigidBody &A = contactManifolds[i]->getBody0();
+			const RigidBody &B = contactManifolds[i]->getBody1();
+
+			unsigned int *layerA = (A.getInvMass() != 0) ? &data.bodyLayers[m_bodyIndices[A.getWorldIndex()]] : nullptr;
+			unsigned int *layerB = (B.getInvMass() != 0) ? &data.bodyLayers[m_bodyIndices[B.getWorldIndex()]] : nullptr;
+
+			unsigned int fromA = layerA ? *layerA : 0;
+			unsigned int fromB = layerB ? *layerB : 0;
+
+			if (layerB && fromA != UINT_MAX && fromA + 1 < *layerB) { *layerB = fromA + 1; isChanged = true; }
+			if (layerA && fromB != UINT_MAX && fromB + 1 < *layerA) { *layerA = fromB + 1; isChanged = true; }
+		}
+	}
+
+	// Sort the manifolds by their lower body's layer. The lane breaks ties, so the order is always the same.
+	data.shockOrder.clear();
+
+	unsigned int numGroups = data.groupManifoldStarts.size() - 1;
+
+	for (unsigned int group = 0; group < numGroups; group++)
+	{
+		unsigned int firstManifold = data.groupManifoldStarts[group];
+		unsigned int numGroupManifolds = data.groupManifoldStarts[group + 1] - firstManifold;
+
+		for (unsigned int lane = 0; lane < numGroupManifolds; lane++)
+		{
+			const ContactBundle &bundle = data.bundles[data.groupBundleStarts[group]];
+
+			unsigned int layerA = (bundle.bodyA[lane]->getInvMass() != 0) ? data.bodyLayers[bundle.indexA[lane]] : 0;
+			unsigned int layerB = (bundle.bodyB[lane]->getInvMass() != 0) ? data.bodyLayers[bundle.indexB[lane]] : 0;
+
+			unsigned long long layer = std::min(layerA, layerB);
+			data.shockOrder.push_back((layer << 32) | (group * SIMD_LANES + lane));
+		}
+	}
+
+	std::sort(data.shockOrder.begin(), data.shockOrder.end());
+
+	for (unsigned int i = 0; i < data.shockOrder.size(); i++)
+	{
+		unsigned int group = (unsigned int)(data.shockOrder[i] & 0xFFFFFFFF) / SIMD_LANES;
+		unsigned int lane = (unsigned int)(data.shockOrder[i] & 0xFFFFFFFF) % SIMD_LANES;
+
+		unsigned int firstBundle = data.groupBundleStarts[group];
+		unsigned int endBundle = data.groupBundleStarts[group + 1];
+
+		const ContactBundle &first = data.bundles[firstBundle];
+
+		unsigned int layerA = (first.bodyA[lane]->getInvMass() != 0) ? data.bodyLayers[first.indexA[lane]] : 0;
+		unsigned int layerB = (first.bodyB[lane]->getInvMass() != 0) ? data.bodyLayers[first.indexB[lane]] : 0;
+
+		// Bodies in the same layer push each other as usual
+		for (unsigned int j = firstBundle; j < endBundle && data.bundles[j].contacts[lane]; j++)
+		{
+			solveShockLane(data.bundles[j], lane, layerA < layerB, layerB < layerA);
+		}
+	}
+}
+
+bool ContactResolver::isBlockSolverUsed() const
+{
+	// The block solver writes straight to the bodies, which mass splitting can't allow
+	return m_isBlockSolverEnabled && !m_isMassSplittingEnabled;
+}
+
+void ContactResolver::loadSplitVelocities(SolverData &data, unsigned int firstGroup, unsigned int endGroup, bool isPseudo)
+{
+	if (!m_isMassSplittingEnabled) { return; }
+
+	// Each manifold starts from its bodies' shared velocities, the first bundle of its group has a lane for every manifold
+	for (unsigned int group = firstGroup; group < endGroup; group++)
+	{
+		const ContactBundle &bundle = data.bundles[data.groupBundleStarts[group]];
+
+		for (unsigned int lane = 0; lane < SIMD_LANES; lane++)
+		{
+			if (!bundle.contacts[lane]) { continue; }
+
+			if (isPseudo)
+			{
+				data.splitVelocities[bundle.slotA[lane]] = data.pushVelocities[bundle.indexA[lane]];
+				data.splitAngularVelocities[bundle.slotA[lane]] = data.turnVelocities[bundle.indexA[lane]];
+				data.splitVelocities[bundle.slotB[lane]] = data.pushVelocities[bundle.indexB[lane]];
+				data.splitAngularVelocities[bundle.slotB[lane]] = data.turnVelocities[bundle.indexB[lane]];
+			}
+			else
+			{
+				data.splitVelocities[bundle.slotA[lane]] = bundle.bodyA[lane]->getVelocity();
+				data.splitAngularVelocities[bundle.slotA[lane]] = bundle.bodyA[lane]->getAngularVelocity();
+				data.splitVelocities[bundle.slotB[lane]] = bundle.bodyB[lane]->getVelocity();
+				data.splitAngularVelocities[bundle.slotB[lane]] = bundle.bodyB[lane]->getAngularVelocity();
+			}
+		}
+	}
+}
+
+void ContactResolver::averageSplitVelocities(Island &island, SolverData &data, bool isPseudo, unsigned int begin, unsigned int end)
+{
+	for (unsigned int i = begin; i < end; i++)
+	{
+		unsigned int first = data.bodySlotStarts[i];
+		unsigned int last = data.bodySlotStarts[i + 1];
+
+		// Bodies only held by joints keep their velocities
+		if (first == last) { continue; }
+
+		Vec3 velocity(0, 0, 0), angularVelocity(0, 0, 0);
+
+		for (unsigned int j = first; j < last; j++)
+		{
+			velocity += data.splitVelocities[data.bodySlots[j]];
+			angularVelocity += data.splitAngularVelocities[data.bodySlots[j]];
+		}
+
+		Scalar invCount = 1 / (Scalar)(last - first);
+		velocity = velocity * invCount;
+		angularVelocity = angularVelocity * invCount;
+
+		if (isPseudo)
+		{
+			data.pushVelocities[i] = velocity;
+			data.turnVelocities[i] = angularVelocity;
+		}
+		else
+		{
+			island.bodies[i]->setVelocity(velocity);
+			island.bodies[i]->setAngularVelocity(angularVelocity);
+		}
+	}
+}
+
+void ContactResolver::averageSplitVelocities(Island &island, SolverData &data, bool isPseudo, bool isParallel)
+{
+	if (!m_isMassSplittingEnabled) { return; }
+
+	unsigned int numBodies = island.bodies.size();
+
+	if (!isParallel)
+	{
+		averageSplitVelocities(island, data, isPseudo, 0, numBodies);
+		return;
+	}
+
+	// Each body only reads its own copies, any split will do
+	unsigned int numBatches = (numBodies + BODIES_PER_BATCH - 1) / BODIES_PER_BATCH;
+
+	m_threadPool.run(numBatches, [&](unsigned int i)
+	{
+		unsigned int begin = i * BODIES_PER_BATCH;
+		averageSplitVelocities(island, data, isPseudo, begin, std::min(begin + BODIES_PER_BATCH, numBodies));
+	});
+}
+
+void ContactResolver::gatherBundle(SolverData &data, const ContactBundle &bundle, bool isPseudo, Scalar velA[3][SIMD_LANES], Scalar angVelA[3][SIMD_LANES], Scalar velB[3][SIMD_LANES], Scalar angVelB[3][SIMD_LANES])
+{
+	if (m_isMassSplittingEnabled)
+	{
+		gatherPseudoVelocities(bundle.slotA, data.splitVelocities, data.splitAngularVelocities, velA, angVelA);
+		gatherPseudoVelocities(bundle.slotB, data.splitVelocities, data.splitAngularVelocities, velB, angVelB);
+	}
+	else if (isPseudo)
+	{
+		gatherPseudoVelocities(bundle.indexA, data.pushVelocities, data.turnVelocities, velA, angVelA);
+		gatherPseudoVelocities(bundle.indexB, data.pushVelocities, data.turnVelocities, velB, angVelB);
+	}
+	else
+	{
+		gatherVelocities(bundle.bodyA, velA, angVelA);
+		gatherVelocities(bundle.bodyB, velB, angVelB);
+	}
+}
+
+void ContactResolver::scatterBundle(SolverData &data, const ContactBundle &bundle, bool isPseudo, const Scalar velA[3][SIMD_LANES], const Scalar angVelA[3][SIMD_LANES], const Scalar velB[3][SIMD_LANES], const Scalar angVelB[3][SIMD_LANES])
+{
+	if (m_isMassSplittingEnabled)
+	{
+		scatterPseudoVelocities(bundle.slotA, data.splitVelocities, data.splitAngularVelocities, velA, angVelA);
+		scatterPseudoVelocities(bundle.slotB, data.splitVelocities, data.splitAngularVelocities, velB, angVelB);
+	}
+	else if (isPseudo)
+	{
+		scatterPseudoVelocities(bundle.indexA, data.pushVelocities, data.turnVelocities, velA, angVelA);
+		scatterPseudoVelocities(bundle.indexB, data.pushVelocities, data.turnVelocities, velB, angVelB);
+	}
+	else
+	{
+		scatterVelocities(bundle.bodyA, velA, angVelA);
+		scatterVelocities(bundle.bodyB, velB, angVelB);
+	}
+}
+
+//--------------------------
+//	HELPERS		
+//--------------------------
+
+static inline unsigned int getIslandSize(const Island &island)
+{
+	// Joints count as one contact each
+	unsigned int numContacts = island.joints.size();
+
+	for (unsigned int i = 0; i < island.manifolds.size(); i++)
+	{
+		numContacts += island.manifolds[i]->getNumContacts();
+	}
+
+	return numContacts;
+}
+
+static inline void gatherVelocities(RigidBody* const bodies[], Scalar vel[3][SIMD_LANES], Scalar angVel[3][SIMD_LANES])
+{
+	for (unsigned int lane = 0; lane < SIMD_LANES; lane++)
+	{
+		if (bodies[lane])
+		{
+			const Vec3 &v = bodies[lane]->getVelocity();
+			const Vec3 &w = bodies[lane]->getAngularVelocity();
+
+			vel[0][lane] = v.x; vel[1][lane] = v.y; vel[2][lane] = v.z;
+			angVel[0][lane] = w.x; angVel[1][lane] = w.y; angVel[2][lane] = w.z;
+		}
+		else
+		{
+			vel[0][lane] = 0; vel[1][lane] = 0; vel[2][lane] = 0;
+			angVel[0][lane] = 0; angVel[1][lane] = 0; angVel[2][lane] = 0;
+		}
+	}
+}
+
+static inline void scatterVelocities(RigidBody* const bodies[], const Scalar vel[3][SIMD_LANES], const Scalar angVel[3][SIMD_LANES])
+{
+	for (unsigned int lane = 0; lane < SIMD_LANES; lane++)
+	{
+		// Static bodies don't move, and might be shared with other lanes and islands
+		if (bodies[lane] && bodies[lane]->getInvMass() != 0)
+		{
+			bodies[lane]->setVelocity(Vec3(vel[0][lane], vel[1][lane], vel[2][lane]));
+			bodies[lane]->setAngularVelocity(Vec3(angVel[0][lane], angVel[1][lane], angVel[2][lane]));
+		}
+	}
+}
+
+static inline void gatherPseudoVelocities(const unsigned int indices[], const std::vector<Vec3> &pushVel, const std::vector<Vec3> &turnVel, Scalar vel[3][SIMD_LANES], Scalar angVel[3][SIMD_LANES])
+{
+	for (unsigned int lane = 0; lane < SIMD_LANES; lane++)
+	{
+		const Vec3 &v = pushVel[indices[lane]];
+		const Vec3 &w = turnVel[indices[lane]];
+
+		vel[0][lane] = v.x; vel[1][lane] = v.y; vel[2][lane] = v.z;
+		angVel[0][lane] = w.x; angVel[1][lane] = w.y; angVel[2][lane] = w.z;
+	}
+}
+
+static inline void scatterPseudoVelocities(const unsigned int indices[], std::vector<Vec3> &pushVel, std::vector<Vec3> &turnVel, const Scalar vel[3][SIMD_LANES], const Scalar angVel[3][SIMD_LANES])
+{
+	unsigned int staticIndex = pushVel.size() - 1;
+
+	for (unsigned int lane = 0; lane < SIMD_LANES; lane++)
+	{
+		// The static entry must stay zero
+		if (indices[lane] != staticIndex)
+		{
+			pushVel[indices[lane]] = Vec3(vel[0][lane], vel[1][lane], vel[2][lane]);
+			turnVel[indices[lane]] = Vec3(angVel[0][lane], angVel[1][lane], angVel[2][lane]);
+		}
+	}
+}
+
+static inline void tangentBasis(const Vec3 &normal, Vec3 &tangent0, Vec3 &tangent1)
+{
+	// Always picks the same tangents for the same normal, so friction impulses can be warm started
+	if (scalar_abs(normal.x) > 0.57735f)
+	{
+		tangent0 = Vec3(normal.y, -normal.x, 0);
+	}
+	else
+	{
+		tangent0 = Vec3(0, normal.z, -normal.y);
+	}
+
+	tangent0.normalize();
+	tangent1 = normal.cross(tangent0);
+}
+
+// Relative velocity of the lanes' bodies along a jacobian row
+static inline SimdFloat rowVelocity(const Scalar dir[3][SIMD_LANES], const Scalar angularA[3][SIMD_LANES], const Scalar angularB[3][SIMD_LANES], 
+	const SimdFloat vA[3], const SimdFloat wA[3], const SimdFloat vB[3], const SimdFloat wB[3])
+{
+	SimdFloat v(0.0f);
+
+	for (unsigned int k = 0; k < 3; k++)
+	{
+		v = v + SimdFloat::load(dir[k]) * (vA[k] - vB[k]) 
+			+ SimdFloat::load(angularA[k]) * wA[k] 
+			- SimdFloat::load(angularB[k]) * wB[k];
+	}
+
+	return v;
+}
+
+// Applies an impulse of f along a jacobian row, positive to body 1 and negative to body 2
+static inline void applyRowImpulse(const SimdFloat &f, const Scalar dir[3][SIMD_LANES], const Scalar invInertiaAngularA[3][SIMD_LANES], const Scalar invInertiaAngularB[3][SIMD_LANES], 
+	const ContactBundle &bundle, SimdFloat vA[3], SimdFloat wA[3], SimdFloat vB[3], SimdFloat wB[3])
+{
+	SimdFloat fA = f * SimdFloat::load(bundle.invMassA);
+	SimdFloat fB = f * SimdFloat::load(bundle.invMassB);
+
+	for (unsigned int k = 0; k < 3; k++)
+	{
+		SimdFloat d = SimdFloat::load(dir[k]);
+
+		vA[k] = vA[k] + d * fA;
+		wA[k] = wA[k] + SimdFloat::load(invInertiaAngularA[k]) * f;
+		vB[k] = vB[k] - d * fB;
+		wB[k] = wB[k] - SimdFloat::load(invInertiaAngularB[k]) * f;
+	}
+}
+
+static inline void solveLanes(ContactBundle &bundle, const Scalar *target, Scalar *impulse, bool isFrictionSolved, bool isNormalSolved, Scalar velA[3][SIMD_LANES], Scalar angVelA[3][SIMD_LANES], Scalar velB[3][SIMD_LANES], Scalar angVelB[3][SIMD_LANES], SimdFloat &maxImpulseDelta)
+{
+	const SimdFloat zero(0.0f);
+
+	SimdFloat vA[3], wA[3], vB[3], wB[3];
+
+	for (unsigned int k = 0; k < 3; k++)
+	{
+		vA[k] = SimdFloat::load(velA[k]);
+		wA[k] = SimdFloat::load(angVelA[k]);
+		vB[k] = SimdFloat::load(velB[k]);
+		wB[k] = SimdFloat::load(angVelB[k]);
+	}
+
+	// Friction first, the normal impulse matters more so it gets the last word
+	if (isFrictionSolved)
+	{
+		SimdFloat limit = SimdFloat::load(bundle.friction) * SimdFloat::load(impulse);
+		SimdFloat negLimit = zero - limit;
+
+		for (unsigned int t = 0; t < 2; t++)
+		{
+			// Impulse needed to stop sliding along the tangent
+			SimdFloat vt = rowVelocity(bundle.tangent[t], bundle.tangentAngularA[t], bundle.tangentAngularB[t], vA, wA, vB, wB);
+			SimdFloat f = (zero - vt) * SimdFloat::load(bundle.tangentEffectiveMass[t]);
+
+			// Clamp the accumulated impulse to the friction cone
+			SimdFloat oldImpulse = SimdFloat::load(bundle.tangentImpulse[t]);
+			SimdFloat newImpulse = simdMin(simdMax(oldImpulse + f, negLimit), limit);
+			newImpulse.store(bundle.tangentImpulse[t]);
+			f = newImpulse - oldImpulse;
+			maxImpulseDelta = simdMax(maxImpulseDelta, simdMax(f, zero - f));
+
+			applyRowImpulse(f, bundle.tangent[t], bundle.tangentInvInertiaAngularA[t], bundle.tangentInvInertiaAngularB[t], bundle, vA, wA, vB, wB);
+		}
+	}
+
+	if (isNormalSolved)
+	{
+		// Impulse needed to reach the target separating velocity
+		SimdFloat vn = rowVelocity(bundle.normal, bundle.angularA, bundle.angularB, vA, wA, vB, wB);
+		SimdFloat f = (SimdFloat::load(target) - vn) * SimdFloat::load(bundle.effectiveMass);
+
+		// Clamp the accumulated impulse, contacts can only push.
+		SimdFloat oldImpulse = SimdFloat::load(impulse);
+		SimdFloat newImpulse = simdMax(oldImpulse + f, zero);
+		newImpulse.store(impulse);
+		f = newImpulse - oldImpulse;
+		maxImpulseDelta = simdMax(maxImpulseDelta, simdMax(f, zero - f));
+
+		applyRowImpulse(f, bundle.normal, bundle.invInertiaAngularA, bundle.invInertiaAngularB, bundle, vA, wA, vB, wB);
+	}
+
+	for (unsigned int k = 0; k < 3; k++)
+	{
+		vA[k].store(velA[k]);
+		wA[k].store(angVelA[k]);
+		vB[k].store(velB[k]);
+		wB[k].store(angVelB[k]);
+	}
+}
+
+// Separating velocity of one lane's contact, added up in the same order as rowVelocity so either gives the same result
+static inline Scalar laneVelocity(const ContactBundle &bundle, unsigned int lane, const Scalar vA[3], const Scalar wA[3], const Scalar vB[3], const Scalar wB[3])
+{
+	Scalar v = 0;
+
+	for (unsigned int k = 0; k < 3; k++)
+	{
+		v = v + bundle.normal[k][lane] * (vA[k] - vB[k]) 
+			+ bundle.angularA[k][lane] * wA[k] 
+			- bundle.angularB[k][lane] * wB[k];
+	}
+
+	return v;
+}
+
+// Applies an impulse of f along one lane's normal, the same way as applyRowImpulse
+static inline void applyLaneImpulse(const ContactBundle &bundle, unsigned int lane, const Scalar &f, Scalar vA[3], Scalar wA[3], Scalar vB[3], Scalar wB[3])
+{
+	Scalar fA = f * bundle.invMassA[lane];
+	Scalar fB = f * bundle.invMassB[lane];
+
+	for (unsigned int k = 0; k < 3; k++)
+	{
+		vA[k] = vA[k] + bundle.normal[k][lane] * fA;
+		wA[k] = wA[k] + bundle.invInertiaAngularA[k][lane] * f;
+		vB[k] = vB[k] - bundle.normal[k][lane] * fB;
+		wB[k] = wB[k] - bundle.invInertiaAngularB[k][lane] * f;
+	}
+}
+
+static inline void solveShockLane(ContactBundle &bundle, unsigned int lane, bool isAFrozen, bool isBFrozen)
+{
+	RigidBody &A = *bundle.bodyA[lane];
+	RigidBody &B = *bundle.bodyB[lane];
+
+	Vec3 normal(bundle.normal[0][lane], bundle.normal[1][lane], bundle.normal[2][lane]);
+	Vec3 angularA(bundle.angularA[0][lane], bundle.angularA[1][lane], bundle.angularA[2][lane]);
+	Vec3 angularB(bundle.angularB[0][lane], bundle.angularB[1][lane], bundle.angularB[2][lane]);
+
+	// Worked out from the bodies, since the bundles' masses may be split. A frozen body is treated as static.
+	Scalar invMassA = isAFrozen ? 0 : A.getInvMass();
+	Scalar invMassB = isBFrozen ? 0 : B.getInvMass();
+	Vec3 invInertiaAngularA = (invMassA != 0) ? A.getInvInertiaTensorWorld() * angularA : Vec3(0, 0, 0);
+	Vec3 invInertiaAngularB = (invMassB != 0) ? B.getInvInertiaTensorWorld() * angularB : Vec3(0, 0, 0);
+
+	Scalar denom = invMassA + invMassB + angularA.dot(invInertiaAngularA) + angularB.dot(invInertiaAngularB);
+
+	if (denom <= 0) { return; }
+
+	Scalar vn = normal.dot(A.getVelocity() - B.getVelocity()) + angularA.dot(A.getAngularVelocity()) - angularB.dot(B.getAngularVelocity());
+	Scalar f = (bundle.targetVelocity[lane] - vn) / denom;
+
+	Scalar oldImpulse = bundle.normalImpulse[lane];
+	bundle.normalImpulse[lane] = (oldImpulse + f > 0) ? oldImpulse + f : 0;
+	f = bundle.normalImpulse[lane] - oldImpulse;
+
+	if (invMassA != 0)
+	{
+		A.setVelocity(A.getVelocity() + normal * (f * invMassA));
+		A.setAngularVelocity(A.getAngularVelocity() + invInertiaAngularA * f);
+	}
+
+	if (invMassB != 0)
+	{
+		B.setVelocity(B.getVelocity() - normal * (f * invMassB));
+		B.setAngularVelocity(B.getAngularVelocity() - invInertiaAngularB * f);
+	}
+}
+
+static inline void prepareBlock(ContactBlock &block, const ContactBundle *bundles, unsigned int numBundles, unsigned int lane)
+{
+	const unsigned int N = MAX_BLOCK_CONTACTS;
+
+	// A manifold's contacts fill the first bundles of its group
+	block.numContacts = 0;
+	while (block.numContacts < numBundles && bundles[block.numContacts].contacts[lane]) { block.numContacts++; }
+
+	block.isInvertible = false;
+
+	// Single contacts need nothing more, and bigger manifolds are solved one contact at a time
+	if (block.numContacts < 2 || block.numContacts > MAX_BLOCK_CONTACTS) { return; }
+
+	unsigned int n = block.numContacts;
+	Scalar maxDiagonal = 0;
+
+	for (unsigned int i = 0; i < n; i++)
+	{
+		const ContactBundle &bundle = bundles[i];
+		Scalar invMass = bundle.invMassA[lane] + bundle.invMassB[lane];
+
+		for (unsigned int j = 0; j < n; j++)
+		{
+			const ContactBundle &other = bundles[j];
+			Scalar normalDot = 0, angular = 0;
+
+			for (unsigned int k = 0; k < 3; k++)
+			{
+				normalDot += bundle.normal[k][lane] * other.normal[k][lane];
+				angular += bundle.angularA[k][lane] * other.invInertiaAngularA[k][lane] + bundle.angularB[k][lane] * other.invInertiaAngularB[k][lane];
+			}
+
+			block.coupling[i][j] = invMass * normalDot + angular;
+		}
+
+		maxDiagonal = (block.coupling[i][i] > maxDiagonal) ? block.coupling[i][i] : maxDiagonal;
+	}
+
+	// Gauss-Jordan elimination with partial pivoting
+	Scalar a[N][N];
+
+	for (unsigned int i = 0; i < n; i++)
+	{
+		for (unsigned int j = 0; j < n; j++)
+		{
+			a[i][j] = block.coupling[i][j];
+			block.invCoupling[i][j] = (i == j) ? 1.0f : 0.0f;
+		}
+	}
+
+	for (unsigned int col = 0; col < n; col++)
+	{
+		unsigned int pivot = col;
+
+		for (unsigned int row = col + 1; row < n; row++)
+		{
+			if (scalar_abs(a[row][col]) > scalar_abs(a[pivot][col])) { pivot = row; }
+		}
+
+		// Contacts on top of each other, or in a line, leave the matrix close to singular
+		if (scalar_abs(a[pivot][col]) < maxDiagonal * 1e-3f) { return; }
+
+		for (unsigned int j = 0; j < n; j++)
+		{
+			std::swap(a[col][j], a[pivot][j]);
+			std::swap(block.invCoupling[col][j], block.invCoupling[pivot][j]);
+		}
+
+		Scalar invPivot = 1 / a[col][col];
+
+		for (unsigned int j = 0; j < n; j++)
+		{
+			a[col][j] *= invPivot;
+			block.invCoupling[col][j] *= invPivot;
+		}
+
+		for (unsigned int row = 0; row < n; row++)
+		{
+			if (row == col) { continue; }
+
+			Scalar factor = a[row][col];
+
+			for (unsigned int j = 0; j < n; j++)
+			{
+				a[row][j] -= factor * a[col][j];
+				block.invCoupling[row][j] -= factor * block.invCoupling[col][j];
+			}
+		}
+	}
+
+	block.isInvertible = true;
+}
+
+static inline Scalar solveBlock(const ContactBlock &block, ContactBundle *bundles, unsigned int lane)
+{
+	const unsigned int N = MAX_BLOCK_CONTACTS;
+	unsigned int n = block.numContacts;
+
+	if (n == 0) { return 0; }
+
+	RigidBody &A = *bundles[0].bodyA[lane];
+	RigidBody &B = *bundles[0].bodyB[lane];
+
+	const Vec3 &velA = A.getVelocity(), &angVelA = A.getAngularVelocity();
+	const Vec3 &velB = B.getVelocity(), &angVelB = B.getAngularVelocity();
+
+	Scalar vA[3] = { velA.x, velA.y, velA.z }, wA[3] = { angVelA.x, angVelA.y, angVelA.z };
+	Scalar vB[3] = { velB.x, velB.y, velB.z }, wB[3] = { angVelB.x, angVelB.y, angVelB.z };
+
+	Scalar oldImpulse[N], newImpulse[N], b[N];
+	Scalar maxDelta = 0;
+	bool isSolved = false;
+
+	if (block.isInvertible)
+	{
+		// With x the total impulses, each contact's separating velocity minus its target is K * x - b
+		for (unsigned int i = 0; i < n; i++)
+		{
+			oldImpulse[i] = bundles[i].normalImpulse[lane];
+			b[i] = bundles[i].targetVelocity[lane] - laneVelocity(bundles[i], lane, vA, wA, vB, wB);
+		}
+
+		for (unsigned int i = 0; i < n; i++)
+		{
+			for (unsigned int j = 0; j < n; j++)
+			{
+				b[i] += block.coupling[i][j] * oldImpulse[j];
+			}
+		}
+
+		// First try every contact pushing
+		isSolved = true;
+
+		for (unsigned int i = 0; i < n; i++)
+		{
+			newImpulse[i] = 0;
+
+			for (unsigned int j = 0; j < n; j++)
+			{
+				newImpulse[i] += block.invCoupling[i][j] * b[j];
+			}
+
+			isSolved = isSolved && newImpulse[i] >= 0;
+		}
+
+		// Two contacts are few enough to try the rest, where a contact that doesn't push must be separating
+		if (!isSolved && n == 2)
+		{
+			const Scalar (&K)[N][N] = block.coupling;
+
+			if (b[0] > 0 && K[1][0] * (b[0] / K[0][0]) - b[1] >= 0)
+			{
+				newImpulse[0] = b[0] / K[0][0];
+				newImpulse[1] = 0;
+				isSolved = true;
+			}
+			else if (b[1] > 0 && K[0][1] * (b[1] / K[1][1]) - b[0] >= 0)
+			{
+				newImpulse[0] = 0;
+				newImpulse[1] = b[1] / K[1][1];
+				isSolved = true;
+			}
+			else if (b[0] <= 0 && b[1] <= 0)
+			{
+				newImpulse[0] = 0;
+				newImpulse[1] = 0;
+				isSolved = true;
+			}
+		}
+	}
+
+	if (isSolved)
+	{
+		for (unsigned int i = 0; i < n; i++)
+		{
+			Scalar delta = newImpulse[i] - oldImpulse[i];
+
+			applyLaneImpulse(bundles[i], lane, delta, vA, wA, vB, wB);
+			bundles[i].normalImpulse[lane] = newImpulse[i];
+			maxDelta = std::max(maxDelta, scalar_abs(delta));
+		}
+	}
+	else
+	{
+		// Fall back to one contact at a time, giving the same result as solveLanes
+		for (unsigned int i = 0; i < n; i++)
+		{
+			ContactBundle &bundle = bundles[i];
+
+			Scalar f = (bundle.targetVelocity[lane] - laneVelocity(bundle, lane, vA, wA, vB, wB)) * bundle.effectiveMass[lane];
+			Scalar old = bundle.normalImpulse[lane];
+			Scalar sum = old + f;
+
+			bundle.normalImpulse[lane] = (sum > 0) ? sum : 0;
+
+			Scalar delta = bundle.normalImpulse[lane] - old;
+			applyLaneImpulse(bundle, lane, delta, vA, wA, vB, wB);
+			maxDelta = std::max(maxDelta, scalar_abs(delta));
+		}
+	}
+
+	// Static bodies don't move, and might be shared with other lanes and islands
+	if (A.getInvMass() != 0)
+	{
+		A.setVelocity(Vec3(vA[0], vA[1], vA[2]));
+		A.setAngularVelocity(Vec3(wA[0], wA[1], wA[2]));
+	}
+
+	if (B.getInvMass() != 0)
+	{
+		B.setVelocity(Vec3(vB[0], vB[1], vB[2]));
+		B.setAngularVelocity(Vec3(wB[0], wB[1], wB[2]));
+	}
+
+	return maxDelta;
 }
 
 } // namespace lt
\ No newline at end of file
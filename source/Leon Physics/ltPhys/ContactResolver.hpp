@@ -1,46 +1,308 @@
 #ifndef LTPHYS_CONTACTRESOLVER_H
 #define LTPHYS_CONTACTRESOLVER_H
 
-#include <list>
 #include <vector>
 
 #include "ContactManifold.hpp"
+#include "Island.hpp"
+#include "ContactBundle.hpp"
+#include "ThreadPool.hpp"
 
 namespace lt
 {
 
-////////////////////////////////////////////////////////////
-/// @brief Stores the velocity response of one collision 
-////////////////////////////////////////////////////////////
-struct CollisionResponse
-{
-	RigidBody *body;
-	Vec3 changeInVelocity;
-	Vec3 changeInAngularVelocity;
-};
-
 /** ContactResolver.hpp
  *	@brief Resolves the contacts found by the contact generator.
  *
+ *  Collision responses are solved with sequential impulses. Each
+ *  velocity iteration applies a corrective impulse at every contact 
+ *  point in turn, while clamping the total impulse applied at each 
+ *  point so contacts never pull bodies together. More iterations 
+ *  converge closer to the exact response at a higher cost.
+ *
+ *  Friction is solved in the same iterations, along two tangents
+ *  of each contact. The friction impulse is kept within the 
+ *  contact's normal impulse times the bodies' combined friction.
+ *
+ *  Contacts that carried over from last update are warm started,
+ *  their previous impulses are applied before iterating so the 
+ *  iterations only have to refine them.
+ *
+ *  An island stops iterating early once no contact or joint 
+ *  impulse changes by more than the velocity tolerance in an 
+ *  iteration, so resting islands are cheap. The iterations used
+ *  are kept on the island.
+ *
+ *  Each island is solved on its own, since islands can't affect 
+ *  each other. Islands are shared out between the resolver's
+ *  threads, largest first so a big island doesn't hold up the 
+ *  update at the end. Each island is always solved by one thread 
+ *  in the same order, so the results don't depend on the number 
+ *  of threads.
+ *
+ *  Every island's manifolds are coloured so that no two manifolds 
+ *  of a colour share a dynamic body. The contacts of each colour 
+ *  are prepared into bundles of SIMD_LANES contacts, which are 
+ *  solved a lane per contact with SIMD instructions. Preparing 
+ *  works out each contact's jacobians, effective masses and target
+ *  velocities once per update, the iterations only read the bundles.
+ *
+ *  Joints are solved in the same iterations, before the contacts 
+ *  of their island. They're warm started like contacts, and their
+ *  drift is removed with split impulses along with the contacts'
+ *  penetration. Joints of large islands are solved by a single 
+ *  thread between colours.
+ *
+ *  The block solver can be enabled for manifolds of 2 to 4 
+ *  contacts, like a box resting on a box. Their friction is solved 
+ *  as usual, then the normal impulses of each manifold are solved 
+ *  together as a small linear complementarity problem. 2 contacts
+ *  try every combination of pushing contacts, 3 or 4 contacts are 
+ *  solved directly and only kept if every contact pushes. When no
+ *  solution is found the manifold falls back to sequential impulses.
+ *
+ *  Tall stacks need many iterations for the weight of the top to
+ *  reach the bottom. Shock propagation can be enabled to add a 
+ *  last pass after the velocity iterations. Bodies are layered 
+ *  by how many contacts they are from a static body, and the 
+ *  contacts are solved once from the bottom layer up, with the 
+ *  lower body of each contact treated as immovable.
+ *
+ *  Interpenetration is solved with split impulses. Pseudo impulses
+ *  are applied to a separate set of pseudo velocities that push 
+ *  the bodies apart without adding to their real velocities. The 
+ *  pseudo velocities move each body once, after every contact of 
+ *  its island has been solved.
+ *
+ *  Large islands, like a collapsing wall, are split further. Each 
+ *  of their colours is solved in parallel, and every thread 
+ *  finishes a colour before the next one starts.
+ *
+ *  Colouring runs out when many manifolds share a body, like a
+ *  pile of crates. Mass splitting can be enabled instead. Each 
+ *  body's mass is split evenly between its manifolds, and every
+ *  manifold is solved against its own copy of its bodies' 
+ *  velocities in a single parallel sweep. The copies are then 
+ *  averaged back into the bodies. The sweeps converge slower than
+ *  sequential impulses, but every manifold of an island can be 
+ *  solved at once, and the results don't depend on the number 
+ *  of threads.
+ *
  *  @author Leon Turpin
  *  @date May 2014
  */
 class ContactResolver
 {
 public:
+	////////////////////////////////////////////////////////////		
+	/// @brief Default Constructor
+	////////////////////////////////////////////////////////////		
+	ContactResolver();
+
 	////////////////////////////////////////////////////////////		
 	/// @brief Applies velocities and moves objects to resolve 
 	/// interpenetration and collision forces.
 	///
-	/// @param colData List of collisions to resolve.
+	/// @param islands Islands of contacts to resolve.
+	/// @param timeStep The length of the update.
+	///
+	////////////////////////////////////////////////////////////			
+	void resolveContacts(std::vector<Island> &islands, const Scalar& timeStep);
+
+	////////////////////////////////////////////////////////////		
+	/// @brief Resolves the contacts of a single island.
+	///
+	/// @param island Island of contacts to resolve.
+	/// @param timeStep The length of the update.
 	///
 	////////////////////////////////////////////////////////////			
-	void resolveContacts(std::vector<ContactManifold> &contactManifolds);
+	void resolveIsland(Island &island, const Scalar& timeStep);
+
+	////////////////////////////////////////////////////////////		
+	/// @brief Set the most velocity iterations used to solve 
+	/// an island's contacts each update.
+	////////////////////////////////////////////////////////////		
+	void setVelocityIterations(unsigned int iterations);
+
+	////////////////////////////////////////////////////////////		
+	/// @brief Set the fewest velocity iterations used to solve
+	/// an island's contacts, even if it has converged.
+	////////////////////////////////////////////////////////////		
+	void setMinVelocityIterations(unsigned int iterations);
+
+	////////////////////////////////////////////////////////////		
+	/// @brief Set the impulse change under which an island is
+	/// considered solved. An island stops iterating once no 
+	/// impulse changes by more than this in an iteration. Zero
+	/// always uses every iteration.
+	////////////////////////////////////////////////////////////		
+	void setVelocityTolerance(const Scalar& tolerance);
+
+	////////////////////////////////////////////////////////////		
+	/// @brief Set the number of iterations used to push 
+	/// interpenetrating bodies apart each update.
+	////////////////////////////////////////////////////////////		
+	void setPositionIterations(unsigned int iterations);
+
+	////////////////////////////////////////////////////////////		
+	/// @brief Set the depth of penetration that is left alone,
+	/// so resting contacts stay touching.
+	////////////////////////////////////////////////////////////		
+	void setPenetrationSlop(const Scalar& slop);
+
+	////////////////////////////////////////////////////////////		
+	/// @brief Set the fraction of the penetration past the slop
+	/// that is removed each update.
+	////////////////////////////////////////////////////////////		
+	void setPenetrationCorrection(const Scalar& correction);
+
+	////////////////////////////////////////////////////////////		
+	/// @brief Set the closing speed under which contacts don't
+	/// bounce. Keeps resting contacts from jittering.
+	////////////////////////////////////////////////////////////		
+	void setRestitutionThreshold(const Scalar& threshold);
+
+	////////////////////////////////////////////////////////////		
+	/// @brief Set how much of last update's impulses are 
+	/// applied to the contacts before iterating. 0 disables 
+	/// warm starting, 1 applies the full impulses.
+	////////////////////////////////////////////////////////////		
+	void setWarmStartFactor(const Scalar& factor);
+
+	////////////////////////////////////////////////////////////		
+	/// @brief Set the number of threads used to resolve 
+	/// islands, including the thread that calls resolveContacts.
+	/// Defaults to the number of hardware threads.
+	////////////////////////////////////////////////////////////		
+	void setNumThreads(unsigned int numThreads);
+
+	////////////////////////////////////////////////////////////		
+	/// @brief Set the number of contacts at which an island is
+	/// split into colours and solved by every thread together.
+	////////////////////////////////////////////////////////////		
+	void setLargeIslandSize(unsigned int numContacts);
+
+	////////////////////////////////////////////////////////////		
+	/// @brief Enable or disable solving the normal impulses of
+	/// manifolds with 2 to 4 contacts together. Stacks converge
+	/// in fewer iterations, but each iteration costs more.
+	////////////////////////////////////////////////////////////		
+	void setIsBlockSolverEnabled(bool isBlockSolverEnabled);
+
+	////////////////////////////////////////////////////////////		
+	/// @brief Enable or disable solving every manifold of an
+	/// island at once with mass splitting, instead of colour by
+	/// colour. The block solver isn't used with mass splitting.
+	////////////////////////////////////////////////////////////		
+	void setIsMassSplittingEnabled(bool isMassSplittingEnabled);
+
+	////////////////////////////////////////////////////////////		
+	/// @brief Enable or disable a last pass over each island's
+	/// contacts from the ground up, treating the lower body of
+	/// each contact as immovable. Keeps tall stacks standing with
+	/// few iterations, at the cost of some accuracy.
+	////////////////////////////////////////////////////////////		
+	void setIsShockPropagationEnabled(bool isShockPropagationEnabled);
+
+	unsigned int getNumThreads() const;
+	unsigned int getLargeIslandSize() const;
+	bool isBlockSolverEnabled() const;
+	bool isMassSplittingEnabled() const;
+	bool isShockPropagationEnabled() const;
+	unsigned int getVelocityIterations() const;
+	unsigned int getMinVelocityIterations() const;
+	const Scalar& getVelocityTolerance() const;
+	unsigned int getPositionIterations() const;
+	const Scalar& getPenetrationSlop() const;
+	const Scalar& getPenetrationCorrection() const;
+	const Scalar& getRestitutionThreshold() const;
+	const Scalar& getWarmStartFactor() const;
+
 private:
-	void resolveMotion(ContactManifold& manifold, std::list<CollisionResponse> &collisionResponseRegistry);
-	void calcImpulse(ContactManifold& contact, std::list<CollisionResponse> &collisionResponseRegistry);
-	void resolveAllInterpenetrations(std::vector<ContactManifold> &contactManifolds);
-	void resolveInterpenetration(ContactManifold& manifold);
+	unsigned int m_velocityIterations;
+	unsigned int m_minVelocityIterations;
+	Scalar m_velocityTolerance;
+	unsigned int m_positionIterations;
+	Scalar m_penetrationSlop;
+	Scalar m_penetrationCorrection;
+	Scalar m_restitutionThreshold;
+	Scalar m_warmStartFactor;
+
+	unsigned int m_largeIslandSize;
+	bool m_isBlockSolverEnabled;
+	bool m_isMassSplittingEnabled;
+	bool m_isShockPropagationEnabled;
+
+	Scalar m_timeStep; // Length of the update being resolved
+
+	ThreadPool m_threadPool;
+	std::vector<unsigned int> m_islandOrder; // Indices of the islands to resolve, largest first
+	std::vector<unsigned int> m_largeIslands; // Indices of the islands to split into colours
+	std::vector<unsigned int> m_bodyIndices; // Index of each body in its island, by world index. Shared, each island only writes its own bodies
+
+	////////////////////////////////////////////////////////////		
+	/// Scratch space for solving an island. Manifolds of a 
+	/// colour are split into groups of SIMD_LANES, and each 
+	/// group's contacts make up a run of bundles.
+	////////////////////////////////////////////////////////////		
+	struct SolverData
+	{
+		std::vector<Vec3> pushVelocities; // Linear pseudo velocity of each of the island's bodies, plus a zero entry
+		std::vector<Vec3> turnVelocities; // Angular pseudo velocity of each of the island's bodies, plus a zero entry
+
+		std::vector<unsigned long long> bodyColours; // Colours used by each of the island's bodies
+		std::vector<unsigned int> manifoldColours; // Colour of each manifold
+		std::vector<ContactManifold*> colouredManifolds; // Scratch space for sorting manifolds by colour
+		std::vector<unsigned int> colourStarts; // Index of the first manifold of each colour, plus the end
+
+		std::vector<ContactBundle> bundles;
+		std::vector<unsigned int> colourGroupStarts; // Index of the first group of each colour, plus the end
+		std::vector<unsigned int> groupManifoldStarts; // Index of the first manifold of each group, plus the end
+		std::vector<unsigned int> groupBundleStarts; // Index of the first bundle of each group, plus the end
+		std::vector<ContactBlock> blocks; // The block solver's view of each group's manifolds, a block per lane
+		std::vector<Scalar> groupImpulseDeltas; // Largest impulse change of each group in the last velocity iteration
+
+		std::vector<Vec3> splitVelocities; // Each manifold's copy of its bodies' velocities when mass splitting, or pseudo velocities while pushing, plus a zero entry
+		std::vector<Vec3> splitAngularVelocities; // Each manifold's copy of its bodies' angular velocities
+		std::vector<unsigned int> bodySlotStarts; // Index of each body's first copy in bodySlots, plus the end
+		std::vector<unsigned int> bodySlots; // The copies of each body's velocities, in manifold order
+
+		std::vector<unsigned int> bodyLayers; // Number of contacts between each body and a static body, for shock propagation
+		std::vector<unsigned long long> shockOrder; // Each manifold's layer and lane, in the order shock propagation solves them
+	};
+
+	std::vector<SolverData> m_solverData; // One for each island being solved at once
+
+	typedef void (ContactResolver::*GroupFunction)(SolverData &data, unsigned int firstGroup, unsigned int endGroup);
+
+	void resolveIsland(Island &island, SolverData &data);
+	void resolveLargeIsland(Island &island, SolverData &data);
+	void fitBodyIndices(const Island &island);
+	void prepareBodies(Island &island, SolverData &data);
+	void colourManifolds(Island &island, SolverData &data);
+	void splitManifolds(Island &island, SolverData &data);
+	void groupManifolds(SolverData &data, std::vector<ContactManifold*> &contactManifolds);
+	void solveGroupColours(SolverData &data, GroupFunction function);
+
+	void prepareJoints(Island &island);
+	Scalar solveJoints(Island &island);
+	void solvePushJoints(Island &island, SolverData &data);
+	void prepareBundles(SolverData &data, std::vector<ContactManifold*> &contactManifolds, unsigned int firstGroup, unsigned int endGroup);
+	void warmStart(SolverData &data, unsigned int firstGroup, unsigned int endGroup);
+	void solveBundles(SolverData &data, unsigned int firstGroup, unsigned int endGroup);
+	Scalar largestImpulseDelta(SolverData &data);
+	bool isConverged(unsigned int iterations, const Scalar &impulseDelta) const;
+	void storeImpulses(SolverData &data, unsigned int firstGroup, unsigned int endGroup);
+	void solvePushBundles(SolverData &data, unsigned int firstGroup, unsigned int endGroup);
+	void applyPseudoVelocities(Island &island, SolverData &data, unsigned int begin, unsigned int end);
+	void propagateShock(Island &island, SolverData &data);
+
+	bool isBlockSolverUsed() const;
+	void loadSplitVelocities(SolverData &data, unsigned int firstGroup, unsigned int endGroup, bool isPseudo);
+	void averageSplitVelocities(Island &island, SolverData &data, bool isPseudo, unsigned int begin, unsigned int end);
+	void averageSplitVelocities(Island &island, SolverData &data, bool isPseudo, bool isParallel);
+	void gatherBundle(SolverData &data, const ContactBundle &bundle, bool isPseudo, Scalar velA[3][SIMD_LANES], Scalar angVelA[3][SIMD_LANES], Scalar velB[3][SIMD_LANES], Scalar angVelB[3][SIMD_LANES]);
+	void scatterBundle(SolverData &data, const ContactBundle &bundle, bool isPseudo, const Scalar velA[3][SIMD_LANES], const Scalar angVelA[3][SIMD_LANES], const Scalar velB[3][SIMD_LANES], const Scalar angVelB[3][SIMD_LANES]);
 };
 
 } // namespace lt
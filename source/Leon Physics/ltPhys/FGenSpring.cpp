@@ -4,10 +4,12 @@
 
 namespace lt
 {
-FGenSpring::FGenSpring() {}
+FGenSpring::FGenSpring() 
+: m_damping(0), m_isImplicit(false)
+{}
 
 FGenSpring::FGenSpring(const Vec3& pivotInParent, RigidBody* other, const Vec3& pivotInOther, const Scalar& springConstant, const Scalar &restLength, bool isStretchOnly)
-: m_pivotInParent(pivotInParent), m_pivotInOther(pivotInOther), m_other(other), m_springConstant(springConstant), m_restLength(restLength), m_isStretchOnly(isStretchOnly)
+: m_pivotInParent(pivotInParent), m_pivotInOther(pivotInOther), m_other(other), m_springConstant(springConstant), m_restLength(restLength), m_isStretchOnly(isStretchOnly), m_damping(0), m_isImplicit(false)
 {}
 
 void FGenSpring::updateForce(RigidBody &parent, const Scalar &timeStep)
@@ -18,24 +20,53 @@ void FGenSpring::updateForce(RigidBody &parent, const Scalar &timeStep)
 	Vec3 force = parent.getPosition() + relPivotInParent;
 	force -= m_other->getPosition() + relPivotInOther;
 
-	Scalar magnitude = force.length();
-	magnitude -= m_restLength;
+	Scalar length = force.length();
+	Scalar magnitude = length - m_restLength;
+
+	if (length == 0 || (m_isStretchOnly && magnitude <= 0)) { return; }
+
+	Vec3 direction = force / length;
+
+	// Speed the pivots are moving apart at
+	Vec3 pivotVelocity = parent.getVelocity() + parent.getAngularVelocity().cross(relPivotInParent);
+	pivotVelocity -= m_other->getVelocity() + m_other->getAngularVelocity().cross(relPivotInOther);
+	Scalar speed = pivotVelocity.dot(direction);
+
+	// Explicit force, from where the bodies are now
+	Scalar pull = m_springConstant * magnitude + m_damping * speed;
 
-	if(!m_isStretchOnly || (m_isStretchOnly && magnitude > 0))
+	if (m_isImplicit)
 	{
-		magnitude *= m_springConstant;
+		// How easily the pivots move apart, for both bodies, so the force can't overshoot when both ends are sprung
+		Vec3 angularParent = relPivotInParent.cross(direction);
+		Vec3 angularOther = relPivotInOther.cross(direction);
+		Scalar invMass = parent.getInvMass() + angularParent.dot(parent.getInvInertiaTensorWorld() * angularParent);
 
-		force.normalize();
-		force *= -magnitude;
-		parent.applyForce(force, relPivotInParent);
+		if (m_other->getInvMass() != 0)
+		{
+			invMass += m_other->getInvMass() + angularOther.dot(m_other->getInvInertiaTensorWorld() * angularOther);
+		}
+
+		// Force for where the pivots will be at the end of the update, solved for the speed it leaves them at
+		Scalar stiffness = (m_springConstant * timeStep + m_damping) * timeStep * invMass;
+		pull = (m_springConstant * (magnitude + speed * timeStep) + m_damping * speed) / (1 + stiffness);
+
+		// Stretch only springs can't push the pivots apart to reach the rest length
+		if (m_isStretchOnly && pull < 0) { return; }
 	}
+
+	parent.applyForce(direction * -pull, relPivotInParent);
 }
 
+RigidBody* FGenSpring::getConnectedBody() const { return m_other; }
+
 void FGenSpring::setPivotInParent(const Vec3& pivot) {m_pivotInParent = pivot;}
 void FGenSpring::setOther(RigidBody *other) {m_other = other;}
 void FGenSpring::setPivotInOther(const Vec3& pivot) {m_pivotInOther = pivot;}
 void FGenSpring::setSpringConstant(lt::Scalar constant) {m_springConstant = constant;}
 void FGenSpring::setRestLength(lt::Scalar length) {m_restLength = length;}
 void FGenSpring::setIsStretchOnly(bool isStretchOnly) {m_isStretchOnly = isStretchOnly;}
+void FGenSpring::setDamping(lt::Scalar damping) {m_damping = damping;}
+void FGenSpring::setIsImplicit(bool isImplicit) {m_isImplicit = isImplicit;}
 
 } // namespace lt
\ No newline at end of file
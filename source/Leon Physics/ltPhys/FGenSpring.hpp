@@ -13,6 +13,16 @@ namespace lt
  *	@brief Applies a spring force on one rigid body, using another rigid
  *  body as an anchor for the end of the spring.
  *
+ *  Explicit springs use the force for where the bodies are 
+ *  at the start of the update, which stiff springs overshoot.
+ *  Implicit springs use the force for where the update will
+ *  leave the bodies, worked out from the mass the spring 
+ *  pulls against, the same as treating the spring as a soft
+ *  constraint. They lose some energy but stay stable however
+ *  stiff they are. Each spring is worked out on its own, so 
+ *  stiff springs that share bodies are better off as a 
+ *  JointDistance spring.
+ *
  *  @author Leon Turpin
  *  @date January 2014
  */
@@ -32,6 +42,11 @@ public:
 	////////////////////////////////////////////////////////////
 	void updateForce(RigidBody& parent, const Scalar& timeStep);
 
+	////////////////////////////////////////////////////////////
+	/// @brief Get the body at the other end of the spring
+	////////////////////////////////////////////////////////////
+	RigidBody* getConnectedBody() const;
+
 	void setPivotInParent(const Vec3& pivot);
 	void setOther(RigidBody *other);
 	void setPivotInOther(const Vec3& pivot);
@@ -39,6 +54,18 @@ public:
 	void setRestLength(lt::Scalar length);
 	void setIsStretchOnly(bool isStretchOnly);
 
+	////////////////////////////////////////////////////////////
+	/// @brief Set the damping constant, the force per unit of
+	/// speed at which the pivots move apart.
+	////////////////////////////////////////////////////////////
+	void setDamping(lt::Scalar damping);
+
+	////////////////////////////////////////////////////////////
+	/// @brief Use the implicit spring force instead of the 
+	/// explicit one.
+	////////////////////////////////////////////////////////////
+	void setIsImplicit(bool isImplicit);
+
 private:
 	RigidBody *m_other; // The body at the other end of the spring
 
@@ -48,6 +75,9 @@ private:
 	Vec3 m_pivotInOther;
 
 	Scalar m_springConstant;
+	Scalar m_damping;
+
+	bool m_isImplicit; // If true the force is solved for the end of the update
 
 	Scalar m_restLength;
 };
@@ -27,6 +27,16 @@ public:
 	/// associated rigid body
 	////////////////////////////////////////////////////////////
 	virtual void updateForce(RigidBody &rigidBody, const Scalar &timeStep) = 0;
+
+	////////////////////////////////////////////////////////////
+	/// @brief Get the other body the generator connects its 
+	/// associated rigid body to, if any. Connected bodies are 
+	/// kept in the same island.
+	///
+	/// @return The connected body, or nullptr.
+	///
+	////////////////////////////////////////////////////////////
+	virtual RigidBody* getConnectedBody() const { return nullptr; }
 };
 
 } // namespace lt
@@ -10,10 +10,13 @@ ForceGeneratorRegistry::ForceGeneratorRegistry()
 
 void ForceGeneratorRegistry::updateForces(Scalar timeStep)
 {
-	// Call the force generators on their paired rigid body
+	// Call the force generators on their paired rigid body, sleeping bodies don't need forces.
 	for (unsigned int i = 0; i < m_registry.size(); i++)
 	{
-		m_registry[i].forceGen->updateForce(*m_registry[i].body, timeStep);
+		if (m_registry[i].body->isAwake())
+		{
+			m_registry[i].forceGen->updateForce(*m_registry[i].body, timeStep);
+		}
 	}
 }
 
@@ -76,6 +79,11 @@ void ForceGeneratorRegistry::clear()
 	m_registry.clear();
 }
 
+const std::vector<ForceGenRegistration>& ForceGeneratorRegistry::getRegistrations() const
+{
+	return m_registry;
+}
+
 //--------------------------
 //	PRIVATES			
 //--------------------------
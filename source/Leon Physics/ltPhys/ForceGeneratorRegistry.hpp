@@ -43,6 +43,7 @@ public:
 
 	////////////////////////////////////////////////////////////
 	/// @brief Calls the all the force generator's updaet functions
+	/// for bodies that are awake.
 	/// 
 	/// @param timeStep passed to the force generators as the
 	/// time in seconds that has elapsed since the last update.
@@ -78,6 +79,11 @@ public:
 	////////////////////////////////////////////////////////////	
 	void clear();
 
+	////////////////////////////////////////////////////////////	
+	/// @brief Get all the registrations in the system
+	////////////////////////////////////////////////////////////	
+	const std::vector<ForceGenRegistration>& getRegistrations() const;
+
 private:
 	std::vector<ForceGenRegistration> m_registry;
 
@@ -0,0 +1,46 @@
+#ifndef LTPHYS_ISLAND_HPP
+#define LTPHYS_ISLAND_HPP
+
+#include <vector>
+
+#include "RigidBody.hpp"
+#include "ContactManifold.hpp"
+#include "Joint.hpp"
+
+namespace lt
+{
+
+////////////////////////////////////////////////////////////
+/// @brief A group of dynamic bodies that are connected by 
+/// contacts, joints or force generators, along with the 
+/// contact manifolds and joints between them. 
+///
+/// Bodies in different islands can't affect each other this
+/// update, so each island can be solved on its own. Static
+/// bodies don't connect islands, they can be in contact with
+/// bodies of any number of islands.
+///
+/// @author Leon Turpin
+/// @date November 2014
+////////////////////////////////////////////////////////////
+struct Island
+{
+	/** The dynamic bodies in the island */
+	std::vector<RigidBody*> bodies;
+
+	/** The contact manifolds touching the island's bodies */
+	std::vector<ContactManifold*> manifolds;
+
+	/** The joints holding the island's bodies */
+	std::vector<Joint*> joints;
+
+	/** False if every body in the island is sleeping */
+	bool isAwake;
+
+	/** The number of velocity iterations the contact resolver used on the island in its last solve */
+	unsigned int velocityIterations;
+};
+
+} // namespace lt
+
+#endif // LTPHYS_ISLAND_HPP
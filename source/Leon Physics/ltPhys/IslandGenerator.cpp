@@ -0,0 +1,228 @@
+#include "IslandGenerator.hpp"
+
+namespace lt
+{
+
+static inline bool isInWorld(const RigidBody &body, const std::vector<RigidBody*> &rigidBodies);
+
+IslandGenerator::IslandGenerator()
+{}
+
+void IslandGenerator::generateIslands(const std::vector<RigidBody*>& rigidBodies, std::vector<ContactManifold>& contactManifolds, const ForceGeneratorRegistry& forceGenRegistry, const std::vector<Joint*>& joints, const std::vector<Articulation*>& articulations)
+{
+	unsigned int numBodies = rigidBodies.size();
+
+	// Every body starts in its own set
+	m_parent.resize(numBodies);
+	m_rank.assign(numBodies, 0);
+	m_islandOfRoot.assign(numBodies, -1);
+
+	for (unsigned int i = 0; i < numBodies; i++)
+	{
+		m_parent[i] = i;
+	}
+
+	// Join the sets of dynamic bodies in contact. Static bodies don't join islands.
+	for (unsigned int i = 0; i < contactManifolds.size(); i++)
+	{
+		const RigidBody &body0 = contactManifolds[i].getBody0();
+		const RigidBody &body1 = contactManifolds[i].getBody1();
+
+		if (body0.getInvMass() != 0 && body1.getInvMass() != 0)
+		{
+			_union(body0.getWorldIndex(), body1.getWorldIndex());
+		}
+	}
+
+	// Join the sets of bodies connected by force generators
+	const std::vector<ForceGenRegistration> &registrations = forceGenRegistry.getRegistrations();
+	for (unsigned int i = 0; i < registrations.size(); i++)
+	{
+		const RigidBody *other = registrations[i].forceGen->getConnectedBody();
+
+		// Springs can outlive the body on their other end
+		if (other != nullptr && other != registrations[i].body && isInWorld(*other, rigidBodies) &&
+			other->getInvMass() != 0 && registrations[i].body->getInvMass() != 0)
+		{
+			_union(registrations[i].body->getWorldIndex(), other->getWorldIndex());
+		}
+	}
+
+	// Join the sets of bodies held by joints. Joints on bodies outside the world are left out.
+	for (unsigned int i = 0; i < joints.size(); i++)
+	{
+		const RigidBody &body0 = joints[i]->getBody0();
+		const RigidBody &body1 = joints[i]->getBody1();
+
+		if (!isInWorld(body0, rigidBodies) || !isInWorld(body1, rigidBodies)) { continue; }
+
+		if (body0.getInvMass() != 0 && body1.getInvMass() != 0)
+		{
+			_union(body0.getWorldIndex(), body1.getWorldIndex());
+		}
+	}
+
+	// Join the sets of each articulation's links
+	for (unsigned int i = 0; i < articulations.size(); i++)
+	{
+		const Articulation &articulation = *articulations[i];
+
+		for (unsigned int j = 1; j < articulation.getNumLinks(); j++)
+		{
+			const RigidBody &body = articulation.getLinkBody(j);
+			const RigidBody &parent = articulation.getLinkBody(articulation.getParent(j));
+
+			if (body.getInvMass() != 0 && parent.getInvMass() != 0)
+			{
+				_union(body.getWorldIndex(), parent.getWorldIndex());
+			}
+		}
+	}
+
+	// Give each set of dynamic bodies an island, in the order of the world's body list.
+	unsigned int numIslands = 0;
+
+	for (unsigned int i = 0; i < numBodies; i++)
+	{
+		if (rigidBodies[i]->getInvMass() == 0) { continue; }
+
+		unsigned int root = _findRoot(i);
+
+		if (m_islandOfRoot[root] < 0)
+		{
+			m_islandOfRoot[root] = numIslands++;
+
+			// Reuse the island's storage from last update
+			if (m_islands.size() < numIslands)
+			{
+				m_islands.push_back(Island());
+			}
+
+			m_islands[numIslands - 1].bodies.clear();
+			m_islands[numIslands - 1].manifolds.clear();
+			m_islands[numIslands - 1].joints.clear();
+			m_islands[numIslands - 1].isAwake = false;
+			m_islands[numIslands - 1].velocityIterations = 0;
+		}
+
+		Island &island = m_islands[m_islandOfRoot[root]];
+		island.bodies.push_back(rigidBodies[i]);
+		island.isAwake = island.isAwake || rigidBodies[i]->isAwake();
+	}
+
+	m_islands.resize(numIslands);
+
+	// Islands sleep and wake as a whole.
+	for (unsigned int i = 0; i < numIslands; i++)
+	{
+		if (m_islands[i].isAwake)
+		{
+			for (unsigned int j = 0; j < m_islands[i].bodies.size(); j++)
+			{
+				m_islands[i].bodies[j]->setAwake(true);
+			}
+		}
+	}
+
+	// Then hand out the manifolds to the island of their dynamic body.
+	for (unsigned int i = 0; i < contactManifolds.size(); i++)
+	{
+		const RigidBody &body0 = contactManifolds[i].getBody0();
+		const RigidBody &body1 = contactManifolds[i].getBody1();
+
+		if (body0.getInvMass() != 0)
+		{
+			m_islands[m_islandOfRoot[_findRoot(body0.getWorldIndex())]].manifolds.push_back(&contactManifolds[i]);
+		}
+		else if (body1.getInvMass() != 0)
+		{
+			m_islands[m_islandOfRoot[_findRoot(body1.getWorldIndex())]].manifolds.push_back(&contactManifolds[i]);
+		}
+	}
+
+	// And the joints the same way
+	for (unsigned int i = 0; i < joints.size(); i++)
+	{
+		const RigidBody &body0 = joints[i]->getBody0();
+		const RigidBody &body1 = joints[i]->getBody1();
+
+		if (!isInWorld(body0, rigidBodies) || !isInWorld(body1, rigidBodies)) { continue; }
+
+		if (body0.getInvMass() != 0)
+		{
+			m_islands[m_islandOfRoot[_findRoot(body0.getWorldIndex())]].joints.push_back(joints[i]);
+		}
+		else if (body1.getInvMass() != 0)
+		{
+			m_islands[m_islandOfRoot[_findRoot(body1.getWorldIndex())]].joints.push_back(joints[i]);
+		}
+	}
+}
+
+std::vector<Island>& IslandGenerator::getIslands()
+{
+	return m_islands;
+}
+
+unsigned int IslandGenerator::getNumIslands() const
+{
+	return m_islands.size();
+}
+
+//--------------------------
+//	PRIVATES			
+//--------------------------
+
+unsigned int IslandGenerator::_findRoot(unsigned int index)
+{
+	// Find the root
+	unsigned int root = index;
+	while (m_parent[root] != root)
+	{
+		root = m_parent[root];
+	}
+
+	// Compress the path so later searches are quicker
+	while (m_parent[index] != root)
+	{
+		unsigned int next = m_parent[index];
+		m_parent[index] = root;
+		index = next;
+	}
+
+	return root;
+}
+
+void IslandGenerator::_union(unsigned int indexA, unsigned int indexB)
+{
+	unsigned int rootA = _findRoot(indexA);
+	unsigned int rootB = _findRoot(indexB);
+
+	if (rootA == rootB) { return; }
+
+	// Attach the shallower tree under the deeper one
+	if (m_rank[rootA] < m_rank[rootB])
+	{
+		m_parent[rootA] = rootB;
+	}
+	else if (m_rank[rootA] > m_rank[rootB])
+	{
+		m_parent[rootB] = rootA;
+	}
+	else
+	{
+		m_parent[rootB] = rootA;
+		m_rank[rootA]++;
+	}
+}
+
+//--------------------------
+//	HELPERS
+//--------------------------
+
+static inline bool isInWorld(const RigidBody &body, const std::vector<RigidBody*> &rigidBodies)
+{
+	return body.getWorldIndex() < rigidBodies.size() && rigidBodies[body.getWorldIndex()] == &body;
+}
+
+} // namespace lt
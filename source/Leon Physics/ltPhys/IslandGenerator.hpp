@@ -0,0 +1,75 @@
+#ifndef LTPHYS_ISLANDGENERATOR_HPP
+#define LTPHYS_ISLANDGENERATOR_HPP
+
+#include <vector>
+
+#include "RigidBody.hpp"
+#include "ContactManifold.hpp"
+#include "ForceGeneratorRegistry.hpp"
+#include "Joint.hpp"
+#include "Articulation.hpp"
+#include "Island.hpp"
+
+namespace lt
+{
+
+////////////////////////////////////////////////////////////
+/// @brief Splits the world's bodies into islands of bodies 
+/// connected by contacts, joints, articulations or force 
+/// generators.
+///
+/// Islands are found with a union-find over the bodies'
+/// indices in the world's body list. Islands sleep as a 
+/// whole, if any body in an island is awake, the rest of the
+/// island is woken up too.
+///
+/// @author Leon Turpin
+/// @date November 2014
+////////////////////////////////////////////////////////////
+class IslandGenerator
+{
+public:
+	////////////////////////////////////////////////////////////
+	/// @brief Default Constructor
+	////////////////////////////////////////////////////////////
+	IslandGenerator();
+
+	////////////////////////////////////////////////////////////
+	/// @brief Group the bodies into islands.
+	///
+	/// @param rigidBodies The world's bodies.
+	/// @param contactManifolds The contacts generated this update.
+	/// @param forceGenRegistry The world's force generators, 
+	/// generators that attach to another body connect islands.
+	/// @param joints The world's joints.
+	/// @param articulations The world's articulations.
+	///
+	////////////////////////////////////////////////////////////
+	void generateIslands(const std::vector<RigidBody*>& rigidBodies, std::vector<ContactManifold>& contactManifolds, const ForceGeneratorRegistry& forceGenRegistry, const std::vector<Joint*>& joints, const std::vector<Articulation*>& articulations);
+
+	////////////////////////////////////////////////////////////
+	/// @brief Get the islands found by the last call to 
+	/// generateIslands.
+	////////////////////////////////////////////////////////////
+	std::vector<Island>& getIslands();
+
+	////////////////////////////////////////////////////////////
+	/// @brief Get the number of islands found by the last call
+	/// to generateIslands. 
+	////////////////////////////////////////////////////////////
+	unsigned int getNumIslands() const;
+
+private:
+	std::vector<unsigned int> m_parent; // Union-find parent of each body index
+	std::vector<unsigned int> m_rank; // Union-find rank of each root
+	std::vector<int> m_islandOfRoot; // The island index of each root body, or -1
+
+	std::vector<Island> m_islands;
+
+	unsigned int _findRoot(unsigned int index);
+	void _union(unsigned int indexA, unsigned int indexB);
+};
+
+} // namespace lt
+
+#endif // LTPHYS_ISLANDGENERATOR_HPP
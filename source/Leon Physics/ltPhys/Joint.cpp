@@ -0,0 +1,266 @@
+#include "Joint.hpp"
+
+#include <math.h>
+
+namespace lt
+{
+
+Joint::Joint(RigidBody &body0, RigidBody &body1)
+	: m_body0(&body0), m_body1(&body1)
+{
+	m_errorReduction = 0.8f;
+	m_numRows = 0;
+
+	for (unsigned int i = 0; i < MAX_ROWS; i++)
+	{
+		_disableRow(i);
+	}
+}
+
+Joint::~Joint()
+{}
+
+void Joint::prepare(const Scalar &timeStep, const Scalar &warmStartFactor)
+{
+	_buildRows(timeStep);
+
+	RigidBody &A = *m_body0;
+	RigidBody &B = *m_body1;
+
+	Vec3 velA = A.getVelocity(), angVelA = A.getAngularVelocity();
+	Vec3 velB = B.getVelocity(), angVelB = B.getAngularVelocity();
+
+	for (unsigned int i = 0; i < m_numRows; i++)
+	{
+		Row &row = m_rows[i];
+
+		if (row.effectiveMass == 0) { continue; }
+
+		// Static bodies don't take impulses
+		row.invInertiaAngularA = (A.getInvMass() != 0) ? A.getInvInertiaTensorWorld() * row.angularA : Vec3(0, 0, 0);
+		row.invInertiaAngularB = (B.getInvMass() != 0) ? B.getInvInertiaTensorWorld() * row.angularB : Vec3(0, 0, 0);
+
+		Scalar denom = A.getInvMass() * row.linearA.dot(row.linearA) + row.angularA.dot(row.invInertiaAngularA)
+			+ B.getInvMass() * row.linearB.dot(row.linearB) + row.angularB.dot(row.invInertiaAngularB) + row.softness;
+
+		row.effectiveMass = (denom > 0) ? 1 / denom : 0;
+		row.targetPushVelocity = -row.error * m_errorReduction / timeStep;
+		row.pushImpulse = 0;
+
+		// Start from a portion of last update's impulse, within this update's limits
+		row.impulse *= warmStartFactor;
+		row.impulse = (row.impulse < row.lowerLimit) ? row.lowerLimit : row.impulse;
+		row.impulse = (row.impulse > row.upperLimit) ? row.upperLimit : row.impulse;
+
+		_applyImpulse(row, row.impulse, velA, angVelA, velB, angVelB);
+	}
+
+	// Static bodies don't move, and might be shared with other islands
+	if (A.getInvMass() != 0) { A.setVelocity(velA); A.setAngularVelocity(angVelA); }
+	if (B.getInvMass() != 0) { B.setVelocity(velB); B.setAngularVelocity(angVelB); }
+}
+
+Scalar Joint::solveVelocities()
+{
+	RigidBody &A = *m_body0;
+	RigidBody &B = *m_body1;
+
+	Vec3 velA = A.getVelocity(), angVelA = A.getAngularVelocity();
+	Vec3 velB = B.getVelocity(), angVelB = B.getAngularVelocity();
+
+	Scalar maxDelta = 0;
+
+	for (unsigned int i = 0; i < m_numRows; i++)
+	{
+		Row &row = m_rows[i];
+
+		if (row.effectiveMass == 0) { continue; }
+
+		Scalar velocity = row.linearA.dot(velA) + row.angularA.dot(angVelA) + row.linearB.dot(velB) + row.angularB.dot(angVelB);
+
+		// Impulse needed to reach the row's target velocity, soft rows give more the harder they're pushed
+		Scalar f = (row.targetVelocity - velocity - row.softness * row.impulse) * row.effectiveMass;
+
+		// Clamp the accumulated impulse to the row's limits
+		Scalar oldImpulse = row.impulse;
+		row.impulse = oldImpulse + f;
+		row.impulse = (row.impulse < row.lowerLimit) ? row.lowerLimit : row.impulse;
+		row.impulse = (row.impulse > row.upperLimit) ? row.upperLimit : row.impulse;
+
+		Scalar delta = row.impulse - oldImpulse;
+		_applyImpulse(row, delta, velA, angVelA, velB, angVelB);
+
+		maxDelta = (scalar_abs(delta) > maxDelta) ? scalar_abs(delta) : maxDelta;
+	}
+
+	if (A.getInvMass() != 0) { A.setVelocity(velA); A.setAngularVelocity(angVelA); }
+	if (B.getInvMass() != 0) { B.setVelocity(velB); B.setAngularVelocity(angVelB); }
+
+	return maxDelta;
+}
+
+void Joint::solvePushVelocities(Vec3 &pushVelocityA, Vec3 &turnVelocityA, Vec3 &pushVelocityB, Vec3 &turnVelocityB)
+{
+	Vec3 velA = pushVelocityA, angVelA = turnVelocityA;
+	Vec3 velB = pushVelocityB, angVelB = turnVelocityB;
+
+	// Same as the velocity solve, but on the pseudo velocities, aiming to remove the drift
+	for (unsigned int i = 0; i < m_numRows; i++)
+	{
+		Row &row = m_rows[i];
+
+		// Springs pull themselves back, pushing them too would make them rigid
+		if (row.effectiveMass == 0 || row.softness != 0) { continue; }
+
+		Scalar velocity = row.linearA.dot(velA) + row.angularA.dot(angVelA) + row.linearB.dot(velB) + row.angularB.dot(angVelB);
+		Scalar f = (row.targetPushVelocity - velocity) * row.effectiveMass;
+
+		Scalar oldImpulse = row.pushImpulse;
+		row.pushImpulse = oldImpulse + f;
+		row.pushImpulse = (row.pushImpulse < row.lowerLimit) ? row.lowerLimit : row.pushImpulse;
+		row.pushImpulse = (row.pushImpulse > row.upperLimit) ? row.upperLimit : row.pushImpulse;
+
+		_applyImpulse(row, row.pushImpulse - oldImpulse, velA, angVelA, velB, angVelB);
+	}
+
+	if (m_body0->getInvMass() != 0) { pushVelocityA = velA; turnVelocityA = angVelA; }
+	if (m_body1->getInvMass() != 0) { pushVelocityB = velB; turnVelocityB = angVelB; }
+}
+
+void Joint::setErrorReduction(const Scalar &errorReduction) { m_errorReduction = errorReduction; }
+const Scalar& Joint::getErrorReduction() const { return m_errorReduction; }
+RigidBody& Joint::getBody0() const { return *m_body0; }
+RigidBody& Joint::getBody1() const { return *m_body1; }
+
+//--------------------------
+//	PROTECTED
+//--------------------------
+
+void Joint::_setLinearRow(unsigned int index, const Vec3 &direction, const Vec3 &anchorA, const Vec3 &anchorB, const Scalar &error, const Scalar &lowerLimit, const Scalar &upperLimit)
+{
+	Row &row = m_rows[index];
+
+	Vec3 rA = anchorA - m_body0->getPosition();
+	Vec3 rB = anchorB - m_body1->getPosition();
+
+	row.linearA = -direction;
+	row.angularA = -rA.cross(direction);
+	row.linearB = direction;
+	row.angularB = rB.cross(direction);
+
+	// Any non-zero value marks the row active, prepare works out the real one
+	row.effectiveMass = 1;
+	row.error = error;
+	row.targetVelocity = 0;
+	row.lowerLimit = lowerLimit;
+	row.upperLimit = upperLimit;
+	row.softness = 0;
+}
+
+void Joint::_setAngularRow(unsigned int index, const Vec3 &axis, const Scalar &error, const Scalar &lowerLimit, const Scalar &upperLimit)
+{
+	Row &row = m_rows[index];
+
+	row.linearA = Vec3(0, 0, 0);
+	row.angularA = -axis;
+	row.linearB = Vec3(0, 0, 0);
+	row.angularB = axis;
+
+	row.effectiveMass = 1;
+	row.error = error;
+	row.targetVelocity = 0;
+	row.lowerLimit = lowerLimit;
+	row.upperLimit = upperLimit;
+	row.softness = 0;
+}
+
+void Joint::_setRowSpring(unsigned int index, const Scalar &stiffness, const Scalar &damping, const Scalar &timeStep)
+{
+	Row &row = m_rows[index];
+
+	// Implicit spring force, scaled into an impulse and a softness for the row
+	Scalar compliance = timeStep * (damping + timeStep * stiffness);
+
+	// A spring with no stiffness or damping doesn't do anything
+	if (compliance <= 0)
+	{
+		_disableRow(index);
+		return;
+	}
+
+	row.softness = 1 / compliance;
+	row.targetVelocity = -row.error * timeStep * stiffness * row.softness;
+}
+
+void Joint::_disableRow(unsigned int index)
+{
+	Row &row = m_rows[index];
+
+	row.linearA = Vec3(0, 0, 0);
+	row.angularA = Vec3(0, 0, 0);
+	row.linearB = Vec3(0, 0, 0);
+	row.angularB = Vec3(0, 0, 0);
+	row.invInertiaAngularA = Vec3(0, 0, 0);
+	row.invInertiaAngularB = Vec3(0, 0, 0);
+
+	row.effectiveMass = 0;
+	row.error = 0;
+	row.targetVelocity = 0;
+	row.targetPushVelocity = 0;
+	row.lowerLimit = 0;
+	row.upperLimit = 0;
+	row.impulse = 0;
+	row.pushImpulse = 0;
+	row.softness = 0;
+}
+
+void Joint::_setPointRows(unsigned int index, const Vec3 &anchorA, const Vec3 &anchorB)
+{
+	Vec3 error = anchorB - anchorA;
+
+	_setLinearRow(index + 0, Vec3(1, 0, 0), anchorA, anchorB, error.x, -SCALAR_MAX, SCALAR_MAX);
+	_setLinearRow(index + 1, Vec3(0, 1, 0), anchorA, anchorB, error.y, -SCALAR_MAX, SCALAR_MAX);
+	_setLinearRow(index + 2, Vec3(0, 0, 1), anchorA, anchorB, error.z, -SCALAR_MAX, SCALAR_MAX);
+}
+
+void Joint::_setAngleRows(unsigned int index, const Quat &relativeAngle)
+{
+	// The rotation that takes body 2 from where it should be to where it is
+	Quat error = m_body1->getAngle() * (m_body0->getAngle() * relativeAngle).inverse();
+
+	// Small angle approximation of the rotation vector, the long way round is never wanted
+	Scalar sign = (error.w < 0) ? -2.0f : 2.0f;
+
+	_setAngularRow(index + 0, Vec3(1, 0, 0), error.x * sign, -SCALAR_MAX, SCALAR_MAX);
+	_setAngularRow(index + 1, Vec3(0, 1, 0), error.y * sign, -SCALAR_MAX, SCALAR_MAX);
+	_setAngularRow(index + 2, Vec3(0, 0, 1), error.z * sign, -SCALAR_MAX, SCALAR_MAX);
+}
+
+void Joint::_perpendiculars(const Vec3 &axis, Vec3 &perp0, Vec3 &perp1)
+{
+	if (scalar_abs(axis.x) > 0.57735f)
+	{
+		perp0 = Vec3(axis.y, -axis.x, 0);
+	}
+	else
+	{
+		perp0 = Vec3(0, axis.z, -axis.y);
+	}
+
+	perp0.normalize();
+	perp1 = axis.cross(perp0);
+}
+
+//--------------------------
+//	PRIVATES
+//--------------------------
+
+void Joint::_applyImpulse(const Row &row, const Scalar &impulse, Vec3 &velocityA, Vec3 &angularVelocityA, Vec3 &velocityB, Vec3 &angularVelocityB) const
+{
+	velocityA += row.linearA * (m_body0->getInvMass() * impulse);
+	angularVelocityA += row.invInertiaAngularA * impulse;
+	velocityB += row.linearB * (m_body1->getInvMass() * impulse);
+	angularVelocityB += row.invInertiaAngularB * impulse;
+}
+
+} // namespace lt
@@ -0,0 +1,183 @@
+#ifndef LTPHYS_JOINT_HPP
+#define LTPHYS_JOINT_HPP
+
+#include "../lt3DMath/lt3DMath.hpp"
+
+#include "RigidBody.hpp"
+
+namespace lt
+{
+
+////////////////////////////////////////////////////////////
+///	@brief Abstract class for joints. Joints hold two rigid
+/// bodies together by limiting how they can move relative
+/// to each other.
+///
+/// Joints are solved by the contact resolver along with the
+/// contacts, at the velocity level. Each joint is made of
+/// rows, each row removes one direction of relative motion
+/// with an impulse kept between the row's limits. Drift that
+/// builds up in the bodies' positions is removed with split
+/// impulses, the same way the contacts' penetration is.
+///
+/// Unlike a stiff spring, a joint doesn't need short updates
+/// to stay stable. Rows can also be made soft, so they act
+/// like a spring and damper that are solved with the rest
+/// of the rows and contacts instead of as a force. Joints are registered through the World
+/// class and connect their bodies' islands.
+///
+/// @author Leon Turpin
+/// @date November 2014
+////////////////////////////////////////////////////////////
+class Joint
+{
+public:
+	////////////////////////////////////////////////////////////
+	/// @brief Constructor
+	///
+	/// @param body0 First body the joint holds.
+	/// @param body1 Second body the joint holds.
+	///
+	////////////////////////////////////////////////////////////
+	Joint(RigidBody &body0, RigidBody &body1);
+
+	virtual ~Joint();
+
+	////////////////////////////////////////////////////////////
+	/// @brief Called by the contact resolver before iterating.
+	/// Builds the joint's rows from the bodies' current
+	/// positions and warm starts them.
+	///
+	/// @param timeStep The length of the update.
+	/// @param warmStartFactor How much of last update's
+	/// impulses to apply.
+	///
+	////////////////////////////////////////////////////////////
+	void prepare(const Scalar &timeStep, const Scalar &warmStartFactor);
+
+	////////////////////////////////////////////////////////////
+	/// @brief Called by the contact resolver each velocity
+	/// iteration. Applies the impulses that bring each row
+	/// closer to its target velocity.
+	///
+	/// @return The largest change to a row's impulse.
+	///
+	////////////////////////////////////////////////////////////
+	Scalar solveVelocities();
+
+	////////////////////////////////////////////////////////////
+	/// @brief Called by the contact resolver each position 
+	/// iteration. Applies pseudo impulses to the bodies' pseudo
+	/// velocities that pull the joint back together. Static 
+	/// bodies' pseudo velocities are left alone.
+	////////////////////////////////////////////////////////////
+	void solvePushVelocities(Vec3 &pushVelocityA, Vec3 &turnVelocityA, Vec3 &pushVelocityB, Vec3 &turnVelocityB);
+
+	////////////////////////////////////////////////////////////
+	/// @brief Set the fraction of the joint's drift that is
+	/// removed each update.
+	////////////////////////////////////////////////////////////
+	void setErrorReduction(const Scalar &errorReduction);
+
+	const Scalar& getErrorReduction() const;
+
+	RigidBody& getBody0() const;
+	RigidBody& getBody1() const;
+
+protected:
+	static const unsigned int MAX_ROWS = 8;
+
+	////////////////////////////////////////////////////////////
+	/// One direction of relative motion the joint controls.
+	/// The row's velocity is the dot product of its jacobian
+	/// with the bodies' velocities.
+	////////////////////////////////////////////////////////////
+	struct Row
+	{
+		Vec3 linearA; // Jacobian of body 1's velocity
+		Vec3 angularA; // Jacobian of body 1's angular velocity
+		Vec3 linearB; // Jacobian of body 2's velocity
+		Vec3 angularB; // Jacobian of body 2's angular velocity
+		Vec3 invInertiaAngularA; // Body 1's world inverse inertia tensor times its angular jacobian
+		Vec3 invInertiaAngularB; // Body 2's world inverse inertia tensor times its angular jacobian
+
+		Scalar effectiveMass; // One over the mass the impulse acts against, zero for inactive rows
+		Scalar error; // How far the row has drifted from where it should be
+		Scalar targetVelocity; // The velocity the row aims for, like a motor's speed
+		Scalar targetPushVelocity; // The pseudo velocity that removes the row's drift
+		Scalar lowerLimit; // Lowest total impulse
+		Scalar upperLimit; // Highest total impulse
+		Scalar impulse; // Total impulse applied, kept between updates for warm starting
+		Scalar pushImpulse; // Total pseudo impulse applied this update
+		Scalar softness; // How much the row gives per unit of impulse, zero for rigid rows
+	};
+
+	RigidBody *m_body0;
+	RigidBody *m_body1;
+
+	Scalar m_errorReduction;
+
+	Row m_rows[MAX_ROWS];
+	unsigned int m_numRows;
+
+	////////////////////////////////////////////////////////////
+	/// @brief Fill the joint's rows from the bodies' current
+	/// positions. Rows keep their impulse between updates, so
+	/// each row should always be built at the same index.
+	////////////////////////////////////////////////////////////
+	virtual void _buildRows(const Scalar &timeStep) = 0;
+
+	////////////////////////////////////////////////////////////
+	/// @brief Build a row that controls the speed at which
+	/// anchorB moves away from anchorA along direction. The 
+	/// row aims for a velocity of 0, with error being how far
+	/// anchorB has drifted along direction.
+	////////////////////////////////////////////////////////////
+	void _setLinearRow(unsigned int index, const Vec3 &direction, const Vec3 &anchorA, const Vec3 &anchorB, const Scalar &error, const Scalar &lowerLimit, const Scalar &upperLimit);
+
+	////////////////////////////////////////////////////////////
+	/// @brief Build a row that controls the speed at which
+	/// body 2 turns relative to body 1 about axis, with error
+	/// in radians.
+	////////////////////////////////////////////////////////////
+	void _setAngularRow(unsigned int index, const Vec3 &axis, const Scalar &error, const Scalar &lowerLimit, const Scalar &upperLimit);
+
+	////////////////////////////////////////////////////////////
+	/// @brief Make a built row act like a spring of stiffness
+	/// and damping, pulling its error back to 0. The row is 
+	/// solved for where the spring will be at the end of the
+	/// update, so it stays stable however stiff it is. Soft 
+	/// rows have no drift to remove.
+	////////////////////////////////////////////////////////////
+	void _setRowSpring(unsigned int index, const Scalar &stiffness, const Scalar &damping, const Scalar &timeStep);
+
+	////////////////////////////////////////////////////////////
+	/// @brief Turn off a row, like a limit that isn't reached.
+	////////////////////////////////////////////////////////////
+	void _disableRow(unsigned int index);
+
+	////////////////////////////////////////////////////////////
+	/// @brief Build three rows from index that hold anchorB
+	/// on anchorA.
+	////////////////////////////////////////////////////////////
+	void _setPointRows(unsigned int index, const Vec3 &anchorA, const Vec3 &anchorB);
+
+	////////////////////////////////////////////////////////////
+	/// @brief Build three rows from index that keep body 2's
+	/// orientation relative to body 1 at relativeAngle.
+	////////////////////////////////////////////////////////////
+	void _setAngleRows(unsigned int index, const Quat &relativeAngle);
+
+	////////////////////////////////////////////////////////////
+	/// @brief Get two unit vectors perpendicular to axis and
+	/// each other.
+	////////////////////////////////////////////////////////////
+	static void _perpendiculars(const Vec3 &axis, Vec3 &perp0, Vec3 &perp1);
+
+private:
+	void _applyImpulse(const Row &row, const Scalar &impulse, Vec3 &velocityA, Vec3 &angularVelocityA, Vec3 &velocityB, Vec3 &angularVelocityB) const;
+};
+
+} // namespace lt
+
+#endif // LTPHYS_JOINT_HPP
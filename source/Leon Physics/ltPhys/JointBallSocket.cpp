@@ -0,0 +1,29 @@
+#include "JointBallSocket.hpp"
+
+namespace lt
+{
+
+JointBallSocket::JointBallSocket(RigidBody &body0, RigidBody &body1, const Vec3 &anchor)
+	: Joint(body0, body1)
+{
+	m_anchorInBody0 = body0.getTransform().transformInvP(anchor);
+	m_anchorInBody1 = body1.getTransform().transformInvP(anchor);
+	m_numRows = 3;
+}
+
+const Vec3& JointBallSocket::getAnchorInBody0() const { return m_anchorInBody0; }
+const Vec3& JointBallSocket::getAnchorInBody1() const { return m_anchorInBody1; }
+
+//--------------------------
+//	PROTECTED
+//--------------------------
+
+void JointBallSocket::_buildRows(const Scalar & /*timeStep*/)
+{
+	Vec3 anchor0 = m_body0->getTransform() * m_anchorInBody0;
+	Vec3 anchor1 = m_body1->getTransform() * m_anchorInBody1;
+
+	_setPointRows(0, anchor0, anchor1);
+}
+
+} // namespace lt
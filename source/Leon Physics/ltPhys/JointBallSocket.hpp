@@ -0,0 +1,43 @@
+#ifndef LTPHYS_JOINTBALLSOCKET_HPP
+#define LTPHYS_JOINTBALLSOCKET_HPP
+
+#include "../lt3DMath/lt3DMath.hpp"
+
+#include "Joint.hpp"
+
+namespace lt
+{
+
+////////////////////////////////////////////////////////////
+///	@brief Pins two rigid bodies together at a point, they 
+/// can turn freely about it.
+///
+/// @author Leon Turpin
+/// @date November 2014
+////////////////////////////////////////////////////////////
+class JointBallSocket : public Joint
+{
+public:
+	////////////////////////////////////////////////////////////
+	/// @brief Joins the bodies at anchor, given in world space
+	/// at the bodies' current positions.
+	////////////////////////////////////////////////////////////
+	JointBallSocket(RigidBody &body0, RigidBody &body1, const Vec3 &anchor);
+
+	////////////////////////////////////////////////////////////
+	/// @brief Get the anchor in each body's space.
+	////////////////////////////////////////////////////////////
+	const Vec3& getAnchorInBody0() const;
+	const Vec3& getAnchorInBody1() const;
+
+protected:
+	void _buildRows(const Scalar &timeStep);
+
+private:
+	Vec3 m_anchorInBody0;
+	Vec3 m_anchorInBody1;
+};
+
+} // namespace lt
+
+#endif // LTPHYS_JOINTBALLSOCKET_HPP
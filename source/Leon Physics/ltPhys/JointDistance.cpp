@@ -0,0 +1,62 @@
+#include "JointDistance.hpp"
+
+namespace lt
+{
+
+JointDistance::JointDistance(RigidBody &body0, RigidBody &body1, const Vec3 &anchor0, const Vec3 &anchor1)
+	: Joint(body0, body1)
+{
+	m_anchorInBody0 = body0.getTransform().transformInvP(anchor0);
+	m_anchorInBody1 = body1.getTransform().transformInvP(anchor1);
+	m_length = (anchor1 - anchor0).length();
+	m_numRows = 1;
+
+	m_isSpring = false;
+	m_springConstant = 0;
+	m_damping = 0;
+}
+
+void JointDistance::setSpring(const Scalar &springConstant, const Scalar &damping)
+{
+	m_springConstant = springConstant;
+	m_damping = damping;
+	m_isSpring = true;
+}
+
+void JointDistance::setLength(const Scalar &length) { m_length = length; }
+void JointDistance::setIsSpring(bool isSpring) { m_isSpring = isSpring; }
+bool JointDistance::isSpring() const { return m_isSpring; }
+const Scalar& JointDistance::getLength() const { return m_length; }
+const Scalar& JointDistance::getSpringConstant() const { return m_springConstant; }
+const Scalar& JointDistance::getDamping() const { return m_damping; }
+
+//--------------------------
+//	PROTECTED
+//--------------------------
+
+void JointDistance::_buildRows(const Scalar &timeStep)
+{
+	Vec3 anchor0 = m_body0->getTransform() * m_anchorInBody0;
+	Vec3 anchor1 = m_body1->getTransform() * m_anchorInBody1;
+	Vec3 offset = anchor1 - anchor0;
+
+	Scalar distance = offset.length();
+
+	// With the anchors on top of each other there's no direction to push along
+	if (distance == 0)
+	{
+		_disableRow(0);
+		return;
+	}
+
+	Vec3 direction = offset * (1 / distance);
+
+	_setLinearRow(0, direction, anchor0, anchor1, distance - m_length, -SCALAR_MAX, SCALAR_MAX);
+
+	if (m_isSpring)
+	{
+		_setRowSpring(0, m_springConstant, m_damping, timeStep);
+	}
+}
+
+} // namespace lt
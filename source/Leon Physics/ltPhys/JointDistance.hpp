@@ -0,0 +1,65 @@
+#ifndef LTPHYS_JOINTDISTANCE_HPP
+#define LTPHYS_JOINTDISTANCE_HPP
+
+#include "../lt3DMath/lt3DMath.hpp"
+
+#include "Joint.hpp"
+
+namespace lt
+{
+
+////////////////////////////////////////////////////////////
+///	@brief Keeps a point on each of two rigid bodies a set
+/// distance apart, like a rigid rod between them.
+///
+/// The rod can be made a spring instead. Unlike FGenSpring,
+/// it's solved with the other joints and contacts, so stiff
+/// springs that share bodies stay stable too.
+///
+/// @author Leon Turpin
+/// @date November 2014
+////////////////////////////////////////////////////////////
+class JointDistance : public Joint
+{
+public:
+	////////////////////////////////////////////////////////////
+	/// @brief Joins anchor0 on body 1 to anchor1 on body 2, 
+	/// both given in world space at the bodies' current 
+	/// positions. The length starts as the distance between 
+	/// the anchors.
+	////////////////////////////////////////////////////////////
+	JointDistance(RigidBody &body0, RigidBody &body1, const Vec3 &anchor0, const Vec3 &anchor1);
+
+	void setLength(const Scalar &length);
+
+	////////////////////////////////////////////////////////////
+	/// @brief Make the joint a spring that pulls the anchors
+	/// back to its length, with a spring constant and a 
+	/// damping constant like FGenSpring's.
+	////////////////////////////////////////////////////////////
+	void setSpring(const Scalar &springConstant, const Scalar &damping);
+
+	void setIsSpring(bool isSpring);
+
+	bool isSpring() const;
+	const Scalar& getLength() const;
+	const Scalar& getSpringConstant() const;
+	const Scalar& getDamping() const;
+
+protected:
+	void _buildRows(const Scalar &timeStep);
+
+private:
+	Vec3 m_anchorInBody0;
+	Vec3 m_anchorInBody1;
+
+	Scalar m_length;
+
+	bool m_isSpring;
+	Scalar m_springConstant;
+	Scalar m_damping;
+};
+
+} // namespace lt
+
+#endif // LTPHYS_JOINTDISTANCE_HPP
@@ -0,0 +1,28 @@
+#include "JointFixed.hpp"
+
+namespace lt
+{
+
+JointFixed::JointFixed(RigidBody &body0, RigidBody &body1)
+	: Joint(body0, body1)
+{
+	m_anchorInBody0 = body0.getTransform().transformInvP(body1.getPosition());
+	m_relativeAngle = body0.getAngle().inverse() * body1.getAngle();
+
+	// Three rows hold the position, three the orientation
+	m_numRows = 6;
+}
+
+//--------------------------
+//	PROTECTED
+//--------------------------
+
+void JointFixed::_buildRows(const Scalar & /*timeStep*/)
+{
+	Vec3 anchor0 = m_body0->getTransform() * m_anchorInBody0;
+
+	_setPointRows(0, anchor0, m_body1->getPosition());
+	_setAngleRows(3, m_relativeAngle);
+}
+
+} // namespace lt
@@ -0,0 +1,38 @@
+#ifndef LTPHYS_JOINTFIXED_HPP
+#define LTPHYS_JOINTFIXED_HPP
+
+#include "../lt3DMath/lt3DMath.hpp"
+
+#include "Joint.hpp"
+
+namespace lt
+{
+
+////////////////////////////////////////////////////////////
+///	@brief Welds two rigid bodies together so they move as 
+/// one, keeping the offset and orientation they had when the
+/// joint was made.
+///
+/// @author Leon Turpin
+/// @date November 2014
+////////////////////////////////////////////////////////////
+class JointFixed : public Joint
+{
+public:
+	////////////////////////////////////////////////////////////
+	/// @brief Welds the bodies together at their current 
+	/// positions.
+	////////////////////////////////////////////////////////////
+	JointFixed(RigidBody &body0, RigidBody &body1);
+
+protected:
+	void _buildRows(const Scalar &timeStep);
+
+private:
+	Vec3 m_anchorInBody0; // Body 2's centre in body 1's space
+	Quat m_relativeAngle; // Body 2's orientation relative to body 1's
+};
+
+} // namespace lt
+
+#endif // LTPHYS_JOINTFIXED_HPP
@@ -0,0 +1,119 @@
+#include "JointHinge.hpp"
+
+#include <math.h>
+
+namespace lt
+{
+
+static const Scalar RAD_TO_DEG = 57.2957795f;
+
+JointHinge::JointHinge(RigidBody &body0, RigidBody &body1, const Vec3 &anchor, const Vec3 &axis)
+	: Joint(body0, body1)
+{
+	Vec3 unitAxis = axis.normalized();
+	Vec3 reference, unused;
+	_perpendiculars(unitAxis, reference, unused);
+
+	m_anchorInBody0 = body0.getTransform().transformInvP(anchor);
+	m_anchorInBody1 = body1.getTransform().transformInvP(anchor);
+	m_axisInBody0 = body0.getTransform().transformInvV(unitAxis);
+	m_axisInBody1 = body1.getTransform().transformInvV(unitAxis);
+	m_referenceInBody0 = body0.getTransform().transformInvV(reference);
+	m_referenceInBody1 = body1.getTransform().transformInvV(reference);
+
+	m_isLimited = false;
+	m_lowerLimit = 0;
+	m_upperLimit = 0;
+
+	m_isMotorEnabled = false;
+	m_motorSpeed = 0;
+	m_maxMotorTorque = 0;
+
+	// Three rows hold the anchor, two the axis, then the limit and the motor
+	m_numRows = 7;
+}
+
+Scalar JointHinge::getHingeAngle() const
+{
+	Vec3 axis = m_body0->getPointInWorldSpace(m_axisInBody0);
+	Vec3 reference0 = m_body0->getPointInWorldSpace(m_referenceInBody0);
+	Vec3 reference1 = m_body1->getPointInWorldSpace(m_referenceInBody1);
+
+	return scalar_atan2(reference0.cross(reference1).dot(axis), reference0.dot(reference1)) * RAD_TO_DEG;
+}
+
+void JointHinge::setLimits(const Scalar &lowerAngle, const Scalar &upperAngle)
+{
+	m_lowerLimit = lowerAngle;
+	m_upperLimit = upperAngle;
+	m_isLimited = true;
+}
+
+void JointHinge::setMotor(const Scalar &speed, const Scalar &maxTorque)
+{
+	m_motorSpeed = speed;
+	m_maxMotorTorque = maxTorque;
+	m_isMotorEnabled = true;
+}
+
+void JointHinge::setIsLimited(bool isLimited) { m_isLimited = isLimited; }
+void JointHinge::setIsMotorEnabled(bool isMotorEnabled) { m_isMotorEnabled = isMotorEnabled; }
+bool JointHinge::isLimited() const { return m_isLimited; }
+bool JointHinge::isMotorEnabled() const { return m_isMotorEnabled; }
+const Scalar& JointHinge::getLowerLimit() const { return m_lowerLimit; }
+const Scalar& JointHinge::getUpperLimit() const { return m_upperLimit; }
+const Scalar& JointHinge::getMotorSpeed() const { return m_motorSpeed; }
+const Scalar& JointHinge::getMaxMotorTorque() const { return m_maxMotorTorque; }
+
+//--------------------------
+//	PROTECTED
+//--------------------------
+
+void JointHinge::_buildRows(const Scalar &timeStep)
+{
+	Vec3 anchor0 = m_body0->getTransform() * m_anchorInBody0;
+	Vec3 anchor1 = m_body1->getTransform() * m_anchorInBody1;
+
+	_setPointRows(0, anchor0, anchor1);
+
+	// Only turning about the axis is allowed, the axes' cross product is how far they've drifted apart
+	Vec3 axis0 = m_body0->getPointInWorldSpace(m_axisInBody0);
+	Vec3 axis1 = m_body1->getPointInWorldSpace(m_axisInBody1);
+	Vec3 drift = axis0.cross(axis1);
+
+	Vec3 perp0, perp1;
+	_perpendiculars(axis0, perp0, perp1);
+
+	_setAngularRow(3, perp0, drift.dot(perp0), -SCALAR_MAX, SCALAR_MAX);
+	_setAngularRow(4, perp1, drift.dot(perp1), -SCALAR_MAX, SCALAR_MAX);
+
+	// The limit row only pushes the angle back within the limits
+	Scalar angle = getHingeAngle();
+
+	if (m_isLimited && angle <= m_lowerLimit)
+	{
+		_setAngularRow(5, axis0, (angle - m_lowerLimit) / RAD_TO_DEG, 0, SCALAR_MAX);
+	}
+	else if (m_isLimited && angle >= m_upperLimit)
+	{
+		_setAngularRow(5, axis0, (angle - m_upperLimit) / RAD_TO_DEG, -SCALAR_MAX, 0);
+	}
+	else
+	{
+		_disableRow(5);
+	}
+
+	// The motor aims for its speed, with as much impulse as its torque gives over the update
+	if (m_isMotorEnabled)
+	{
+		Scalar maxImpulse = m_maxMotorTorque * timeStep;
+		_setAngularRow(6, axis0, 0, -maxImpulse, maxImpulse);
+		m_rows[6].targetVelocity = m_motorSpeed;
+	}
+	else
+	{
+		_disableRow(6);
+	}
+}
+
+} // namespace lt
@@ -0,0 +1,83 @@
+#ifndef LTPHYS_JOINTHINGE_HPP
+#define LTPHYS_JOINTHINGE_HPP
+
+#include "../lt3DMath/lt3DMath.hpp"
+
+#include "Joint.hpp"
+
+namespace lt
+{
+
+////////////////////////////////////////////////////////////
+///	@brief Joins two rigid bodies at a point so they can only
+/// turn relative to each other about one axis, like a door
+/// on its hinges.
+///
+/// The angle can be kept within limits, and a motor can 
+/// drive the hinge at a set speed with a limited torque.
+///
+/// @author Leon Turpin
+/// @date November 2014
+////////////////////////////////////////////////////////////
+class JointHinge : public Joint
+{
+public:
+	////////////////////////////////////////////////////////////
+	/// @brief Joins the bodies at anchor, turning about axis,
+	/// both given in world space at the bodies' current 
+	/// positions. The hinge's angle starts at 0.
+	////////////////////////////////////////////////////////////
+	JointHinge(RigidBody &body0, RigidBody &body1, const Vec3 &anchor, const Vec3 &axis);
+
+	////////////////////////////////////////////////////////////
+	/// @brief Get the angle body 2 has turned about the axis
+	/// relative to body 1, in degrees.
+	////////////////////////////////////////////////////////////
+	Scalar getHingeAngle() const;
+
+	////////////////////////////////////////////////////////////
+	/// @brief Keep the hinge's angle between lowerAngle and
+	/// upperAngle, in degrees between -180 and 180.
+	////////////////////////////////////////////////////////////
+	void setLimits(const Scalar &lowerAngle, const Scalar &upperAngle);
+
+	void setIsLimited(bool isLimited);
+
+	////////////////////////////////////////////////////////////
+	/// @brief Set the speed the motor turns the hinge at, in
+	/// radians per second, and the most torque it can use.
+	////////////////////////////////////////////////////////////
+	void setMotor(const Scalar &speed, const Scalar &maxTorque);
+
+	void setIsMotorEnabled(bool isMotorEnabled);
+
+	bool isLimited() const;
+	bool isMotorEnabled() const;
+	const Scalar& getLowerLimit() const;
+	const Scalar& getUpperLimit() const;
+	const Scalar& getMotorSpeed() const;
+	const Scalar& getMaxMotorTorque() const;
+
+protected:
+	void _buildRows(const Scalar &timeStep);
+
+private:
+	Vec3 m_anchorInBody0;
+	Vec3 m_anchorInBody1;
+	Vec3 m_axisInBody0;
+	Vec3 m_axisInBody1;
+	Vec3 m_referenceInBody0; // Perpendicular to the axis, the angle is measured between the two references
+	Vec3 m_referenceInBody1;
+
+	bool m_isLimited;
+	Scalar m_lowerLimit;
+	Scalar m_upperLimit;
+
+	bool m_isMotorEnabled;
+	Scalar m_motorSpeed;
+	Scalar m_maxMotorTorque;
+};
+
+} // namespace lt
+
+#endif // LTPHYS_JOINTHINGE_HPP
@@ -0,0 +1,79 @@
+#include "JointSlider.hpp"
+
+namespace lt
+{
+
+JointSlider::JointSlider(RigidBody &body0, RigidBody &body1, const Vec3 &anchor, const Vec3 &axis)
+	: Joint(body0, body1)
+{
+	m_anchorInBody0 = body0.getTransform().transformInvP(anchor);
+	m_anchorInBody1 = body1.getTransform().transformInvP(anchor);
+	m_axisInBody0 = body0.getTransform().transformInvV(axis.normalized());
+	m_relativeAngle = body0.getAngle().inverse() * body1.getAngle();
+
+	m_isLimited = false;
+	m_lowerLimit = 0;
+	m_upperLimit = 0;
+
+	// Two rows hold the anchor on the axis, three the orientation, then the limit
+	m_numRows = 6;
+}
+
+Scalar JointSlider::getDistance() const
+{
+	Vec3 anchor0 = m_body0->getTransform() * m_anchorInBody0;
+	Vec3 anchor1 = m_body1->getTransform() * m_anchorInBody1;
+
+	return (anchor1 - anchor0).dot(m_body0->getPointInWorldSpace(m_axisInBody0));
+}
+
+void JointSlider::setLimits(const Scalar &lowerDistance, const Scalar &upperDistance)
+{
+	m_lowerLimit = lowerDistance;
+	m_upperLimit = upperDistance;
+	m_isLimited = true;
+}
+
+void JointSlider::setIsLimited(bool isLimited) { m_isLimited = isLimited; }
+bool JointSlider::isLimited() const { return m_isLimited; }
+const Scalar& JointSlider::getLowerLimit() const { return m_lowerLimit; }
+const Scalar& JointSlider::getUpperLimit() const { return m_upperLimit; }
+
+//--------------------------
+//	PROTECTED
+//--------------------------
+
+void JointSlider::_buildRows(const Scalar & /*timeStep*/)
+{
+	Vec3 anchor0 = m_body0->getTransform() * m_anchorInBody0;
+	Vec3 anchor1 = m_body1->getTransform() * m_anchorInBody1;
+	Vec3 axis = m_body0->getPointInWorldSpace(m_axisInBody0);
+	Vec3 offset = anchor1 - anchor0;
+
+	Vec3 perp0, perp1;
+	_perpendiculars(axis, perp0, perp1);
+
+	// Body 1's side of the rows acts at body 2's anchor, since the axis slides along with body 1
+	_setLinearRow(0, perp0, anchor1, anchor1, offset.dot(perp0), -SCALAR_MAX, SCALAR_MAX);
+	_setLinearRow(1, perp1, anchor1, anchor1, offset.dot(perp1), -SCALAR_MAX, SCALAR_MAX);
+
+	_setAngleRows(2, m_relativeAngle);
+
+	// The limit row only pushes the distance back within the limits
+	Scalar distance = offset.dot(axis);
+
+	if (m_isLimited && distance <= m_lowerLimit)
+	{
+		_setLinearRow(5, axis, anchor1, anchor1, (distance - m_lowerLimit), 0, SCALAR_MAX);
+	}
+	else if (m_isLimited && distance >= m_upperLimit)
+	{
+		_setLinearRow(5, axis, anchor1, anchor1, (distance - m_upperLimit), -SCALAR_MAX, 0);
+	}
+	else
+	{
+		_disableRow(5);
+	}
+}
+
+} // namespace lt
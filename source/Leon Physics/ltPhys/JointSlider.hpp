@@ -0,0 +1,64 @@
+#ifndef LTPHYS_JOINTSLIDER_HPP
+#define LTPHYS_JOINTSLIDER_HPP
+
+#include "../lt3DMath/lt3DMath.hpp"
+
+#include "Joint.hpp"
+
+namespace lt
+{
+
+////////////////////////////////////////////////////////////
+///	@brief Lets two rigid bodies slide relative to each other
+/// along one axis, without turning, like a piston.
+///
+/// The distance slid can be kept within limits.
+///
+/// @author Leon Turpin
+/// @date November 2014
+////////////////////////////////////////////////////////////
+class JointSlider : public Joint
+{
+public:
+	////////////////////////////////////////////////////////////
+	/// @brief Joins the bodies at anchor, sliding along axis,
+	/// both given in world space at the bodies' current 
+	/// positions. The distance slid starts at 0.
+	////////////////////////////////////////////////////////////
+	JointSlider(RigidBody &body0, RigidBody &body1, const Vec3 &anchor, const Vec3 &axis);
+
+	////////////////////////////////////////////////////////////
+	/// @brief Get how far body 2 has slid along the axis from
+	/// where it started.
+	////////////////////////////////////////////////////////////
+	Scalar getDistance() const;
+
+	////////////////////////////////////////////////////////////
+	/// @brief Keep the distance slid between lowerDistance and
+	/// upperDistance.
+	////////////////////////////////////////////////////////////
+	void setLimits(const Scalar &lowerDistance, const Scalar &upperDistance);
+
+	void setIsLimited(bool isLimited);
+
+	bool isLimited() const;
+	const Scalar& getLowerLimit() const;
+	const Scalar& getUpperLimit() const;
+
+protected:
+	void _buildRows(const Scalar &timeStep);
+
+private:
+	Vec3 m_anchorInBody0;
+	Vec3 m_anchorInBody1;
+	Vec3 m_axisInBody0;
+	Quat m_relativeAngle; // Body 2's orientation relative to body 1's, which is kept
+
+	bool m_isLimited;
+	Scalar m_lowerLimit;
+	Scalar m_upperLimit;
+};
+
+} // namespace lt
+
+#endif // LTPHYS_JOINTSLIDER_HPP
@@ -1,4 +1,5 @@
 #include "RigidBody.hpp"
+#include "BodyStorage.hpp"
 
 #include <cmath>
 #include <iostream>
@@ -21,49 +22,61 @@ RigidBody::RigidBody()
 	m_damping = 1.0f;
 	m_angDamping = 1.0f;
 	m_restitution = 1.0f;
+	m_friction = 0.5f;
 
 	m_invInteriaTensor.setIdentity();
+
+	m_storage = nullptr;
+	m_worldIndex = 0;
+	m_isDerivedDataDirty = true;
+
+	m_articulation = nullptr;
+	m_articulationParent = nullptr;
+
+	m_isAwake = true;
+	m_sleepTimer = 0;
 }
 
 void RigidBody::integrate(const Scalar& timeStep)
 {
-	const Scalar DEG_TO_RAD = 57.2957795f;
+	Vec3 vel = getVelocity();
+	Vec3 angVel = getAngularVelocity();
 
 	// Acceleration due to force
-	Vec3 accel = m_forceAccum * m_invMass;
+	Vec3 accel = _getForceAccum() * getInvMass();
 
-	// Angular acceleration due to torque
-	Vec3 angAccel = m_invInteriaTensor * m_torqueAccum;
+	// Angular acceleration due to torque, which is in world space
+	Vec3 angAccel = getInvInertiaTensorWorld() * _getTorqueAccum();
 	
 	// Update Velocities
-	m_vel += accel * timeStep;
-	m_angVel += angAccel * timeStep;
+	vel += accel * timeStep;
+	angVel += angAccel * timeStep;
 
 	// Apply damping
-	m_vel *= scalar_pow(m_damping, timeStep);
-	m_angVel *= scalar_pow(m_angDamping, timeStep);
+	vel *= scalar_pow(getDamping(), timeStep);
+	angVel *= scalar_pow(getAngularDamping(), timeStep);
 
-	// Update Position
-	m_pos += m_vel * timeStep;
+	// Update Position and angle with the new velocities
+	_setPosition(getPosition() + vel * timeStep);
+	_setAngle(_integrateAngle(getAngle(), angVel, timeStep, INTEGRATOR_EULER));
 
-	// Shitty angle update
-	m_ang = Quat(Vec3(1.0f, 0.0f, 0.0f), m_angVel.x * timeStep * DEG_TO_RAD) * m_ang;
-	m_ang = Quat(Vec3(0.0f, 1.0f, 0.0f), m_angVel.y * timeStep * DEG_TO_RAD) * m_ang;
-	m_ang = Quat(Vec3(0.0f, 0.0f, 1.0f), m_angVel.z * timeStep * DEG_TO_RAD) * m_ang;
+	_setVelocity(vel);
+	_setAngularVelocity(angVel);
 
 	// Clear Accumulators
 	_clearAccums();
-	_calcDerivedData();
+	_setDerivedDataDirty();
 }
 
 void RigidBody::applyCentralForce(const Vec3& force)
 {
-	m_forceAccum += force;
+	_setForceAccum(_getForceAccum() + force);
+	setAwake(true);
 }
 
 void RigidBody::applyForce(const Vec3& force, const Vec3& offset)
 {
-	m_torqueAccum += offset.cross(force);
+	_setTorqueAccum(_getTorqueAccum() + offset.cross(force));
 	applyCentralForce(force);
 }
 
@@ -74,20 +87,49 @@ void RigidBody::applyRelForce(const Vec3& force, const Vec3& offset)
 
 void RigidBody::applyTorque(const Vec3& torque)
 {
-	m_torqueAccum += torque;
+	_setTorqueAccum(_getTorqueAccum() + torque);
+	setAwake(true);
 }
 
 void RigidBody::clearForces()
 {
-	m_torqueAccum = Vec3(0, 0, 0);
-	m_forceAccum = Vec3(0, 0, 0);
+	_clearAccums();
+}
+
+void RigidBody::setAwake(bool isAwake)
+{
+	if (isAwake)
+	{
+		// Only restart the sleep timer if the body was actually sleeping
+		if (!m_isAwake)
+		{
+			m_isAwake = true;
+			m_sleepTimer = 0;
+			_updateIsIntegrated();
+		}
+	}
+	else
+	{
+		m_isAwake = false;
+		m_sleepTimer = 0;
+		_updateIsIntegrated();
+
+		_setVelocity(Vec3(0.0f, 0.0f, 0.0f));
+		_setAngularVelocity(Vec3(0.0f, 0.0f, 0.0f));
+		_clearAccums();
+	}
+}
+
+bool RigidBody::isAwake() const
+{
+	return m_isAwake;
 }
 
 const Vec3 RigidBody::getPointInWorldSpace(const Vec3& point) const
 {
 	Vec3 direction = point;
 	direction.w = 0;
-	return m_transform * direction;
+	return getTransform() * direction;
 }
 
 //--------------------------
@@ -95,49 +137,71 @@ const Vec3 RigidBody::getPointInWorldSpace(const Vec3& point) const
 //--------------------------
 void RigidBody::setPosition(const Vec3& position) 
 { 
-	m_pos = position;
-	m_transform = Transform(m_pos, m_ang); // Update Transform
+	_setPosition(position);
+	_setDerivedDataDirty();
+	setAwake(true);
 }
 
 void RigidBody::setAngle(const Quat& angle) 
 { 
-	m_ang = angle; 
-	m_transform = Transform(m_pos, m_ang); // Update Transform
-	_transformInertiaTensor(m_invInertiaTensorWorld, m_invInteriaTensor, m_transform); // Update World Inertia Tensor 
+	_setAngle(angle);
+	_setDerivedDataDirty();
+	setAwake(true);
 }
 
-void RigidBody::setVelocity(const Vec3& velocity) { m_vel = velocity; }
-void RigidBody::setAngularVelocity(const Vec3& angVel) { m_angVel = angVel; }
-void RigidBody::setInvMass(const Scalar& invMass) { m_invMass = invMass; }
-void RigidBody::setMass(const Scalar& mass) { m_invMass = 1.0f / mass; }
-void RigidBody::setDamping(const Scalar& damping) { m_damping = damping; }
-void RigidBody::setAngularDamping(const Scalar& angularDamping) { m_angDamping = angularDamping; }
+void RigidBody::setPositionAndAngle(const Vec3& position, const Quat& angle)
+{
+	_setPosition(position);
+	_setAngle(angle);
+	_setDerivedDataDirty();
+	setAwake(true);
+}
+
+void RigidBody::setVelocity(const Vec3& velocity) { _setVelocity(velocity); setAwake(true); }
+void RigidBody::setAngularVelocity(const Vec3& angVel) { _setAngularVelocity(angVel); setAwake(true); }
+void RigidBody::setMass(const Scalar& mass) { setInvMass(1.0f / mass); }
 void RigidBody::setRestitution(const Scalar& restitution) { m_restitution = restitution; }
+void RigidBody::setFriction(const Scalar& friction) { m_friction = friction; }
+
+void RigidBody::setDamping(const Scalar& damping)
+{
+	if (m_storage) { m_storage->setDamping(m_worldIndex, damping, getAngularDamping()); }
+	else { m_damping = damping; }
+}
+
+void RigidBody::setAngularDamping(const Scalar& angularDamping)
+{
+	if (m_storage) { m_storage->setDamping(m_worldIndex, getDamping(), angularDamping); }
+	else { m_angDamping = angularDamping; }
+}
+
+void RigidBody::setInvMass(const Scalar& invMass)
+{
+	if (m_storage) { m_storage->setInvMass(m_worldIndex, invMass); }
+	else { m_invMass = invMass; }
+}
 
 void RigidBody::setInertiaTensor(const Mat3& inertiaTensor) 
 { 
-	m_invInteriaTensor = inertiaTensor; 
-	m_invInteriaTensor.invert();
-	_transformInertiaTensor(m_invInertiaTensorWorld, m_invInteriaTensor, m_transform); // Update World Inertia Tensor 
+	setInvInertiaTensor(inertiaTensor.inverse());
 }
 
 void RigidBody::setInertiaTensor(const Vec3& inertiaProducts)
 {
-	m_invInteriaTensor = Mat3(inertiaProducts);
-	m_invInteriaTensor.invert();
-	_transformInertiaTensor(m_invInertiaTensorWorld, m_invInteriaTensor, m_transform); // Update World Inertia Tensor 
+	setInvInertiaTensor(Mat3(inertiaProducts).inverse());
 }
 
 void RigidBody::setInvInertiaTensor(const Vec3& inertiaProducts)
 {
-	m_invInteriaTensor = Mat3(inertiaProducts);
-	_transformInertiaTensor(m_invInertiaTensorWorld, m_invInteriaTensor, m_transform); // Update World Inertia Tensor 
+	setInvInertiaTensor(Mat3(inertiaProducts));
 }
 
 void RigidBody::setInvInertiaTensor(const Mat3& inverseInertiaTensor)
 {
-	m_invInteriaTensor = inverseInertiaTensor;
-	_transformInertiaTensor(m_invInertiaTensorWorld, m_invInteriaTensor, m_transform); // Update World Inertia Tensor 
+	if (m_storage) { m_storage->setInvInertiaTensor(m_worldIndex, inverseInertiaTensor); }
+	else { m_invInteriaTensor = inverseInertiaTensor; }
+
+	_setDerivedDataDirty(); // World Inertia Tensor is out of date
 }
 
 void RigidBody::addCollisionShape(const CollisionShape* colShape)
@@ -158,71 +222,145 @@ int RigidBody::numCollisionShapes() const
 //--------------------------
 //	GETS			
 //--------------------------
-const Vec3& RigidBody::getPosition() const { return m_pos; }
-const Vec3& RigidBody::getVelocity() const { return m_vel; }
-const Quat& RigidBody::getAngle() const { return m_ang; }
-const Vec3& RigidBody::getAngularVelocity() const { return m_angVel; }
-const Scalar RigidBody::getMass() const { return 1.0f / m_invMass; }
-const Scalar& RigidBody::getInvMass() const { return m_invMass; }
-const Scalar& RigidBody::getDamping() const { return m_damping; }
-const Scalar& RigidBody::getAngularDamping() const { return m_angDamping; }
+const Vec3 RigidBody::getPosition() const { return m_storage ? m_storage->getPosition(m_worldIndex) : m_pos; }
+const Vec3 RigidBody::getVelocity() const { return m_storage ? m_storage->getVelocity(m_worldIndex) : m_vel; }
+const Quat RigidBody::getAngle() const { return m_storage ? m_storage->getAngle(m_worldIndex) : m_ang; }
+const Vec3 RigidBody::getAngularVelocity() const { return m_storage ? m_storage->getAngularVelocity(m_worldIndex) : m_angVel; }
+const Scalar RigidBody::getMass() const { return 1.0f / getInvMass(); }
+const Scalar RigidBody::getInvMass() const { return m_storage ? m_storage->getInvMass(m_worldIndex) : m_invMass; }
+const Scalar RigidBody::getDamping() const { return m_storage ? m_storage->getDamping(m_worldIndex) : m_damping; }
+const Scalar RigidBody::getAngularDamping() const { return m_storage ? m_storage->getAngularDamping(m_worldIndex) : m_angDamping; }
 const Scalar& RigidBody::getRestitution() const { return m_restitution; }
-const Mat3 RigidBody::getInertiaTensor() const { return m_invInteriaTensor.inverse(); }
-const Mat3& RigidBody::getInvInertiaTensor() const { return m_invInteriaTensor; }
-const Mat3& RigidBody::getInvInertiaTensorWorld() const { return m_invInertiaTensorWorld; }
-const Transform& RigidBody::getTransform() const { return m_transform; }
+const Scalar& RigidBody::getFriction() const { return m_friction; }
+const Mat3 RigidBody::getInertiaTensor() const { return getInvInertiaTensor().inverse(); }
+const Mat3 RigidBody::getInvInertiaTensor() const { return m_storage ? m_storage->getInvInertiaTensor(m_worldIndex) : m_invInteriaTensor; }
+
+const Mat3& RigidBody::getInvInertiaTensorWorld() const
+{
+	if (m_storage) { return m_storage->getInvInertiaTensorWorld(m_worldIndex); }
+	if (m_isDerivedDataDirty) { _calcDerivedData(); }
+
+	return m_invInertiaTensorWorld;
+}
+
+const Transform& RigidBody::getTransform() const
+{
+	if (m_storage) { return m_storage->getTransform(m_worldIndex); }
+	if (m_isDerivedDataDirty) { _calcDerivedData(); }
+
+	return m_transform;
+}
+
 const std::set<const CollisionShape*>& RigidBody::getCollisionShapes() const { return m_collisionShapes; }
+unsigned int RigidBody::getWorldIndex() const { return m_worldIndex; }
+Articulation* RigidBody::getArticulation() const { return m_articulation; }
+const RigidBody* RigidBody::getArticulationParent() const { return m_articulationParent; }
 
 //--------------------------
 //	PRIVATES			
 //--------------------------
 
-void RigidBody::_clearAccums()
+void RigidBody::_attach(BodyStorage *storage)
 {
-	// Clear force accumulator
-	m_forceAccum = Vec3(0.0f, 0.0f, 0.0f);
-	m_torqueAccum = Vec3(0.0f, 0.0f, 0.0f);
+	storage->setPosition(m_worldIndex, m_pos);
+	storage->setVelocity(m_worldIndex, m_vel);
+	storage->setAngle(m_worldIndex, m_ang);
+	storage->setAngularVelocity(m_worldIndex, m_angVel);
+	storage->setForce(m_worldIndex, m_forceAccum);
+	storage->setTorque(m_worldIndex, m_torqueAccum);
+	storage->setInvMass(m_worldIndex, m_invMass);
+	storage->setInvInertiaTensor(m_worldIndex, m_invInteriaTensor);
+	storage->setDamping(m_worldIndex, m_damping, m_angDamping);
+	storage->resetPreviousState(m_worldIndex);
+
+	m_storage = storage;
+	_updateIsIntegrated();
+	_setDerivedDataDirty();
 }
 
-void RigidBody::_calcDerivedData()
+void RigidBody::_detach()
 {
-	// Calculate the transformation matrix
-	m_transform = Transform(m_pos, m_ang);
-	
-	// Calculate the inverse inertia tensor in world space.
-	_transformInertiaTensor(m_invInertiaTensorWorld, m_invInteriaTensor, m_transform);
+	m_pos = m_storage->getPosition(m_worldIndex);
+	m_vel = m_storage->getVelocity(m_worldIndex);
+	m_ang = m_storage->getAngle(m_worldIndex);
+	m_angVel = m_storage->getAngularVelocity(m_worldIndex);
+	m_forceAccum = m_storage->getForce(m_worldIndex);
+	m_torqueAccum = m_storage->getTorque(m_worldIndex);
+	m_invMass = m_storage->getInvMass(m_worldIndex);
+	m_invInteriaTensor = m_storage->getInvInertiaTensor(m_worldIndex);
+	m_damping = m_storage->getDamping(m_worldIndex);
+	m_angDamping = m_storage->getAngularDamping(m_worldIndex);
+
+	m_storage = nullptr;
+	_setDerivedDataDirty();
 }
 
-//--------------------------
-//	HELPERS		
-//--------------------------
+void RigidBody::_setPosition(const Vec3& position)
+{
+	if (m_storage) { m_storage->setPosition(m_worldIndex, position); }
+	else { m_pos = position; }
+}
+
+void RigidBody::_setVelocity(const Vec3& velocity)
+{
+	if (m_storage) { m_storage->setVelocity(m_worldIndex, velocity); }
+	else { m_vel = velocity; }
+}
+
+void RigidBody::_setAngle(const Quat& angle)
+{
+	if (m_storage) { m_storage->setAngle(m_worldIndex, angle); }
+	else { m_ang = angle; }
+}
+
+void RigidBody::_setAngularVelocity(const Vec3& angVel)
+{
+	if (m_storage) { m_storage->setAngularVelocity(m_worldIndex, angVel); }
+	else { m_angVel = angVel; }
+}
+
+void RigidBody::_setForceAccum(const Vec3& force)
+{
+	if (m_storage) { m_storage->setForce(m_worldIndex, force); }
+	else { m_forceAccum = force; }
+}
 
-static inline void _transformInertiaTensor(Mat3 &iitWorld, const Mat3 &iitBody, const Transform &rotMat)
+void RigidBody::_setTorqueAccum(const Vec3& torque)
 {
-	// Note that the implementation of this function was created by an automated code generator and optimizer.
-	Scalar t4  = rotMat.get(0) * iitBody.get(0) + rotMat.get(1) * iitBody.get(3) + rotMat.get(2) * iitBody.get(6);
-	Scalar t9  = rotMat.get(0) * iitBody.get(1) + rotMat.get(1) * iitBody.get(4) + rotMat.get(2) * iitBody.get(7);
-	Scalar t14 = rotMat.get(0) * iitBody.get(2) + rotMat.get(1) * iitBody.get(5) + rotMat.get(2) * iitBody.get(8);
+	if (m_storage) { m_storage->setTorque(m_worldIndex, torque); }
+	else { m_torqueAccum = torque; }
+}
 
-	Scalar t28 = rotMat.get(4) * iitBody.get(0) + rotMat.get(5) * iitBody.get(3) + rotMat.get(6) * iitBody.get(6);
-	Scalar t33 = rotMat.get(4) * iitBody.get(1) + rotMat.get(5) * iitBody.get(4) + rotMat.get(6) * iitBody.get(7);
-	Scalar t38 = rotMat.get(4) * iitBody.get(2) + rotMat.get(5) * iitBody.get(5) + rotMat.get(6) * iitBody.get(8);
+void RigidBody::_updateIsIntegrated()
+{
+	if (m_storage) { m_storage->setIsIntegrated(m_worldIndex, m_isAwake && m_articulation == nullptr); }
+}
 
-	Scalar t52 = rotMat.get(8) * iitBody.get(0) + rotMat.get(9) * iitBody.get(3) + rotMat.get(10) * iitBody.get(6);
-	Scalar t57 = rotMat.get(8) * iitBody.get(1) + rotMat.get(9) * iitBody.get(4) + rotMat.get(10) * iitBody.get(7);
-	Scalar t62 = rotMat.get(8) * iitBody.get(2) + rotMat.get(9) * iitBody.get(5) + rotMat.get(10) * iitBody.get(8);
+const Vec3 RigidBody::_getForceAccum() const { return m_storage ? m_storage->getForce(m_worldIndex) : m_forceAccum; }
+const Vec3 RigidBody::_getTorqueAccum() const { return m_storage ? m_storage->getTorque(m_worldIndex) : m_torqueAccum; }
+
+void RigidBody::_clearAccums()
+{
+	// Clear force accumulator
+	_setForceAccum(Vec3(0.0f, 0.0f, 0.0f));
+	_setTorqueAccum(Vec3(0.0f, 0.0f, 0.0f));
+}
 
-	iitWorld[0] = t4 *rotMat.get(0) + t9 *rotMat.get(1) + t14*rotMat.get(2);
-	iitWorld[1] = t4 *rotMat.get(4) + t9 *rotMat.get(5) + t14*rotMat.get(6);
-	iitWorld[2] = t4 *rotMat.get(8) + t9 *rotMat.get(9) + t14*rotMat.get(10);
+void RigidBody::_setDerivedDataDirty()
+{
+	if (m_storage) { m_storage->setDerivedDataDirty(m_worldIndex); }
+	else { m_isDerivedDataDirty = true; }
+}
 
-	iitWorld[3] = t28*rotMat.get(0) + t33*rotMat.get(1) + t38*rotMat.get(2);
-	iitWorld[4] = t28*rotMat.get(4) + t33*rotMat.get(5) + t38*rotMat.get(6);
-	iitWorld[5] = t28*rotMat.get(8) + t33*rotMat.get(9) + t38*rotMat.get(10);
+void RigidBody::_calcDerivedData() const
+{
+	m_isDerivedDataDirty = false;
 
-	iitWorld[6] = t52*rotMat.get(0) + t57*rotMat.get(1) + t62*rotMat.get(2);
-	iitWorld[7] = t52*rotMat.get(4) + t57*rotMat.get(5) + t62*rotMat.get(6);
-	iitWorld[8] = t52*rotMat.get(8) + t57*rotMat.get(9) + t62*rotMat.get(10);
+	// Calculate the transformation matrix
+	m_transform = Transform(m_pos, m_ang);
+	
+	// Calculate the inverse inertia tensor in world space.
+	_transformInertiaTensor(m_invInertiaTensorWorld, m_invInteriaTensor, m_transform);
 }
 
-} // namespace lt
\ No newline at end of file
+} // namespace lt
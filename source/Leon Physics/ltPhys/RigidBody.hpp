@@ -10,9 +10,19 @@
 namespace lt
 {
 
+class Articulation;
+class BodyStorage;
+
 ////////////////////////////////////////////////////////////
 /// @brief A basic non-deformable physics object.
 ///
+/// While the body is in a world, its position, velocities,
+/// angle, forces, mass and derived data live in the world's
+/// BodyStorage, and the body only reads and writes them
+/// there. The body keeps its own copy while it isn't in a
+/// world, which the world takes in when it's added and
+/// hands back when it's removed.
+///
 /// @author Leon Turpin
 /// @date December 2013
 ////////////////////////////////////////////////////////////
@@ -26,6 +36,10 @@ public:
 
     ////////////////////////////////////////////////////////////
 	/// @brief Simulates this physics objects for "timeStep" seconds
+	///
+	/// Worlds don't call this, they move all their bodies at
+	/// once through their BodyStorage. The angle is moved with
+	/// INTEGRATOR_EULER.
 	/// 
 	/// @param timeStep Time in seconds to simulate.
 	/// 
@@ -71,6 +85,25 @@ public:
     ////////////////////////////////////////////////////////////
 	void clearForces();
 
+    ////////////////////////////////////////////////////////////
+	/// @brief Wake the body up or put it to sleep. 
+	///
+	/// Sleeping bodies aren't moved, have no forces applied to 
+	/// them and aren't checked for collisions against other 
+	/// non moving bodies. Putting a body to sleep clears its 
+	/// velocities. Setting the body's position, angle or 
+	/// velocities or applying a force to it wakes it up.
+	///
+	/// @param isAwake True to wake the body, false to put it to sleep.
+	///
+    ////////////////////////////////////////////////////////////
+	void setAwake(bool isAwake);
+
+    ////////////////////////////////////////////////////////////
+	/// @brief Returns true if the body is awake.
+    ////////////////////////////////////////////////////////////
+	bool isAwake() const;
+
     ////////////////////////////////////////////////////////////
 	/// @brief Converts body space position into world space.
 	///
@@ -96,6 +129,12 @@ public:
     ////////////////////////////////////////////////////////////
 	void setAngle(const Quat& angle);
 
+    ////////////////////////////////////////////////////////////
+	/// @brief Sets the position and angle of the body, only 
+	/// updating the transform and inertia tensor once.
+    ////////////////////////////////////////////////////////////
+	void setPositionAndAngle(const Vec3& position, const Quat& angle);
+
     ////////////////////////////////////////////////////////////
 	/// @brief Sets the angular velocity of the body
     ////////////////////////////////////////////////////////////
@@ -126,6 +165,11 @@ public:
     ////////////////////////////////////////////////////////////
 	void setRestitution(const Scalar& restitution);
 
+    ////////////////////////////////////////////////////////////
+	/// @brief Sets the coefficient of friction of the body
+    ////////////////////////////////////////////////////////////
+	void setFriction(const Scalar& friction);
+
     ////////////////////////////////////////////////////////////
 	/// @brief Sets the inertia tensor of the body from inertia products 
     ////////////////////////////////////////////////////////////
@@ -178,20 +222,46 @@ public:
 	////////////////////////////////////////////////////////////
 	const std::set<const CollisionShape*>& getCollisionShapes() const;
 
-	const Vec3& getPosition() const;
-	const Vec3& getVelocity() const;
-	const Quat& getAngle() const;
-	const Vec3& getAngularVelocity() const;
-	const Scalar& getInvMass() const;
+	const Vec3 getPosition() const;
+	const Vec3 getVelocity() const;
+	const Quat getAngle() const;
+	const Vec3 getAngularVelocity() const;
+	const Scalar getInvMass() const;
 	const Scalar getMass() const;
-	const Scalar& getDamping() const;
-	const Scalar& getAngularDamping() const;
+	const Scalar getDamping() const;
+	const Scalar getAngularDamping() const;
 	const Scalar& getRestitution() const;
+	const Scalar& getFriction() const;
 	const Mat3 getInertiaTensor() const;
-	const Mat3& getInvInertiaTensor() const;
+	const Mat3 getInvInertiaTensor() const;
 	const Mat3& getInvInertiaTensorWorld() const;
 	const Transform& getTransform() const;
+
+	////////////////////////////////////////////////////////////
+	/// @brief Get the body's index in its world's body list.
+	/// Only valid while the body is in a world.
+	////////////////////////////////////////////////////////////
+	unsigned int getWorldIndex() const;
+
+	////////////////////////////////////////////////////////////
+	/// @brief Get the articulation the body is a link of, or 
+	/// null. Only set while the articulation is in a world.
+	////////////////////////////////////////////////////////////
+	Articulation* getArticulation() const;
+
+	////////////////////////////////////////////////////////////
+	/// @brief Get the body this one is jointed to in its 
+	/// articulation, or null. The two don't collide.
+	////////////////////////////////////////////////////////////
+	const RigidBody* getArticulationParent() const;
 private:
+	friend class World;
+	friend class Articulation;
+
+	BodyStorage *m_storage; // The world's storage the body's state is in, null while it isn't in a world
+	unsigned int m_worldIndex; // Index in the world's body list, and in its storage
+
+	// The body's own state, only used while m_storage is null
 	Vec3 m_pos; // Position
 	Vec3 m_vel; // Velocity
 
@@ -205,28 +275,65 @@ private:
 	Scalar m_invMass; // Inverse Mass
 	Scalar m_damping; // Damping Coefficient.
 	Scalar m_angDamping; // Angular Damping Coefficient
+
+	// Derived Data, worked out when first read after the state changes
+	mutable Transform m_transform; // This rigid body's transformation matrix.
+	mutable Mat3 m_invInertiaTensorWorld; // inverse interia tensor (World aligned)
+	mutable bool m_isDerivedDataDirty; // True if the derived data is out of date
+
+	// Rarely touched, always kept in the body
 	Scalar m_restitution; // Coefficient of restitution
+	Scalar m_friction; // Coefficient of friction
 
 	std::set<const CollisionShape*> m_collisionShapes;
 
-	// Derived Data
-	Transform m_transform; // This rigid body's transformation matrix.
-	Mat3 m_invInertiaTensorWorld; // inverse interia tensor (World aligned)
+	Articulation *m_articulation; // The articulation that moves the body, instead of integrate
+	const RigidBody *m_articulationParent; // The body's parent link in its articulation
+
+	bool m_isAwake; // False if the body is sleeping
+	Scalar m_sleepTimer; // How long the body has been moving slow enough to sleep
+
+	////////////////////////////////////////////////////////////
+	/// @brief Move the body's state into a world's storage, at
+	/// the body's world index.
+	////////////////////////////////////////////////////////////
+	void _attach(BodyStorage *storage);
+
+	////////////////////////////////////////////////////////////
+	/// @brief Copy the body's state back out of its world's 
+	/// storage, before the world drops it.
+	////////////////////////////////////////////////////////////
+	void _detach();
+
+	// Write the state without waking the body or updating the derived data
+	void _setPosition(const Vec3& position);
+	void _setVelocity(const Vec3& velocity);
+	void _setAngle(const Quat& angle);
+	void _setAngularVelocity(const Vec3& angVel);
+	void _setForceAccum(const Vec3& force);
+	void _setTorqueAccum(const Vec3& torque);
+	const Vec3 _getForceAccum() const;
+	const Vec3 _getTorqueAccum() const;
+
+	////////////////////////////////////////////////////////////
+	/// @brief Tell the storage whether the world's integrator
+	/// should move the body, after it's woken, put to sleep or
+	/// given to an articulation.
+	////////////////////////////////////////////////////////////
+	void _updateIsIntegrated();
 
 	void _clearAccums();
-	void _calcDerivedData();
-};
 
-/**
- * @brief Do an inertia tensor rotation by a transformation matrix.
- *
- * Taken from "Game Physics Engine Development" by Ian Millington.
- * 
- * @param iitWorld The resulting world aligned inverse inertia tensor.
- * @param iitBody The original rigidbody aligned inverse inertia tensor.
- * @param rotMat The transformation to rotate the inertia tensor by.
- */
-static inline void _transformInertiaTensor(Mat3 &iitWorld, const Mat3 &iitBody, const Transform &rotMat);
+	////////////////////////////////////////////////////////////
+	/// @brief Mark the transform and world inverse inertia
+	/// tensor out of date, rather than working them out for 
+	/// every setter called in a row.
+	////////////////////////////////////////////////////////////
+	void _setDerivedDataDirty();
+
+	// Only for a body outside a world, the storage works out its own
+	void _calcDerivedData() const;
+};
 
 } // namespace lt
 
@@ -0,0 +1,116 @@
+#ifndef LTPHYS_SIMDFLOAT_HPP
+#define LTPHYS_SIMDFLOAT_HPP
+
+#include <math.h>
+
+#include "../lt3DMath/lt3DMath.hpp"
+
+// Uses AVX when the compiler targets it (/arch:AVX), SSE otherwise.
+// The project builds Release with /arch:AVX and Debug with SSE.
+// Define LTPHYS_NO_SIMD to fall back to plain scalar code.
+#if !defined(LTPHYS_NO_SIMD)
+	#if defined(__AVX__)
+		#include <immintrin.h>
+		#define LTPHYS_SIMD_AVX
+	#else
+		#include <xmmintrin.h>
+		#define LTPHYS_SIMD_SSE
+	#endif
+#endif
+
+namespace lt
+{
+
+////////////////////////////////////////////////////////////
+/// @brief A pack of floats that are worked on together with
+/// SIMD instructions, one float per lane.
+///
+/// Loads and stores don't need aligned memory. Comparisons
+/// give a mask for simdSelect, which takes a's lanes where
+/// the mask is set and b's elsewhere.
+///
+/// @author Leon Turpin
+/// @date November 2014
+////////////////////////////////////////////////////////////
+#if defined(LTPHYS_SIMD_AVX)
+
+const unsigned int SIMD_LANES = 8;
+
+struct SimdFloat
+{
+	__m256 v;
+
+	SimdFloat() {}
+	SimdFloat(__m256 value) : v(value) {}
+	explicit SimdFloat(Scalar value) : v(_mm256_set1_ps(value)) {}
+
+	static SimdFloat load(const Scalar* data) { return _mm256_loadu_ps(data); }
+	void store(Scalar* data) const { _mm256_storeu_ps(data, v); }
+};
+
+inline SimdFloat operator+(const SimdFloat& a, const SimdFloat& b) { return _mm256_add_ps(a.v, b.v); }
+inline SimdFloat operator-(const SimdFloat& a, const SimdFloat& b) { return _mm256_sub_ps(a.v, b.v); }
+inline SimdFloat operator*(const SimdFloat& a, const SimdFloat& b) { return _mm256_mul_ps(a.v, b.v); }
+inline SimdFloat operator/(const SimdFloat& a, const SimdFloat& b) { return _mm256_div_ps(a.v, b.v); }
+inline SimdFloat simdSqrt(const SimdFloat& a) { return _mm256_sqrt_ps(a.v); }
+inline SimdFloat simdMax(const SimdFloat& a, const SimdFloat& b) { return _mm256_max_ps(a.v, b.v); }
+inline SimdFloat simdMin(const SimdFloat& a, const SimdFloat& b) { return _mm256_min_ps(a.v, b.v); }
+inline SimdFloat simdGreater(const SimdFloat& a, const SimdFloat& b) { return _mm256_cmp_ps(a.v, b.v, _CMP_GT_OQ); }
+inline SimdFloat simdSelect(const SimdFloat& mask, const SimdFloat& a, const SimdFloat& b) { return _mm256_blendv_ps(b.v, a.v, mask.v); }
+
+#elif defined(LTPHYS_SIMD_SSE)
+
+const unsigned int SIMD_LANES = 4;
+
+struct SimdFloat
+{
+	__m128 v;
+
+	SimdFloat() {}
+	SimdFloat(__m128 value) : v(value) {}
+	explicit SimdFloat(Scalar value) : v(_mm_set1_ps(value)) {}
+
+	static SimdFloat load(const Scalar* data) { return _mm_loadu_ps(data); }
+	void store(Scalar* data) const { _mm_storeu_ps(data, v); }
+};
+
+inline SimdFloat operator+(const SimdFloat& a, const SimdFloat& b) { return _mm_add_ps(a.v, b.v); }
+inline SimdFloat operator-(const SimdFloat& a, const SimdFloat& b) { return _mm_sub_ps(a.v, b.v); }
+inline SimdFloat operator*(const SimdFloat& a, const SimdFloat& b) { return _mm_mul_ps(a.v, b.v); }
+inline SimdFloat operator/(const SimdFloat& a, const SimdFloat& b) { return _mm_div_ps(a.v, b.v); }
+inline SimdFloat simdSqrt(const SimdFloat& a) { return _mm_sqrt_ps(a.v); }
+inline SimdFloat simdMax(const SimdFloat& a, const SimdFloat& b) { return _mm_max_ps(a.v, b.v); }
+inline SimdFloat simdMin(const SimdFloat& a, const SimdFloat& b) { return _mm_min_ps(a.v, b.v); }
+inline SimdFloat simdGreater(const SimdFloat& a, const SimdFloat& b) { return _mm_cmpgt_ps(a.v, b.v); }
+inline SimdFloat simdSelect(const SimdFloat& mask, const SimdFloat& a, const SimdFloat& b) { return _mm_or_ps(_mm_and_ps(mask.v, a.v), _mm_andnot_ps(mask.v, b.v)); }
+
+#else
+
+const unsigned int SIMD_LANES = 4;
+
+struct SimdFloat
+{
+	Scalar v[SIMD_LANES];
+
+	SimdFloat() {}
+	explicit SimdFloat(Scalar value) { for (unsigned int i = 0; i < SIMD_LANES; i++) { v[i] = value; } }
+
+	static SimdFloat load(const Scalar* data) { SimdFloat r; for (unsigned int i = 0; i < SIMD_LANES; i++) { r.v[i] = data[i]; } return r; }
+	void store(Scalar* data) const { for (unsigned int i = 0; i < SIMD_LANES; i++) { data[i] = v[i]; } }
+};
+
+inline SimdFloat operator+(const SimdFloat& a, const SimdFloat& b) { SimdFloat r; for (unsigned int i = 0; i < SIMD_LANES; i++) { r.v[i] = a.v[i] + b.v[i]; } return r; }
+inline SimdFloat operator-(const SimdFloat& a, const SimdFloat& b) { SimdFloat r; for (unsigned int i = 0; i < SIMD_LANES; i++) { r.v[i] = a.v[i] - b.v[i]; } return r; }
+inline SimdFloat operator*(const SimdFloat& a, const SimdFloat& b) { SimdFloat r; for (unsigned int i = 0; i < SIMD_LANES; i++) { r.v[i] = a.v[i] * b.v[i]; } return r; }
+inline SimdFloat operator/(const SimdFloat& a, const SimdFloat& b) { SimdFloat r; for (unsigned int i = 0; i < SIMD_LANES; i++) { r.v[i] = a.v[i] / b.v[i]; } return r; }
+inline SimdFloat simdSqrt(const SimdFloat& a) { SimdFloat r; for (unsigned int i = 0; i < SIMD_LANES; i++) { r.v[i] = scalar_sqrt(a.v[i]); } return r; }
+inline SimdFloat simdMax(const SimdFloat& a, const SimdFloat& b) { SimdFloat r; for (unsigned int i = 0; i < SIMD_LANES; i++) { r.v[i] = (a.v[i] > b.v[i]) ? a.v[i] : b.v[i]; } return r; }
+inline SimdFloat simdMin(const SimdFloat& a, const SimdFloat& b) { SimdFloat r; for (unsigned int i = 0; i < SIMD_LANES; i++) { r.v[i] = (a.v[i] < b.v[i]) ? a.v[i] : b.v[i]; } return r; }
+inline SimdFloat simdGreater(const SimdFloat& a, const SimdFloat& b) { SimdFloat r; for (unsigned int i = 0; i < SIMD_LANES; i++) { r.v[i] = (a.v[i] > b.v[i]) ? 1.0f : 0.0f; } return r; }
+inline SimdFloat simdSelect(const SimdFloat& mask, const SimdFloat& a, const SimdFloat& b) { SimdFloat r; for (unsigned int i = 0; i < SIMD_LANES; i++) { r.v[i] = (mask.v[i] != 0) ? a.v[i] : b.v[i]; } return r; }
+
+#endif
+
+} // namespace lt
+
+#endif // LTPHYS_SIMDFLOAT_HPP
@@ -0,0 +1,161 @@
+#include "ThreadPool.hpp"
+
+namespace lt
+{
+
+ThreadPool::ThreadPool()
+{
+	m_task = nullptr;
+	m_numTasks = 0;
+	m_nextTask = 0;
+	m_numTasksDone = 0;
+	m_batch = 0;
+	m_isStopping = false;
+}
+
+ThreadPool::~ThreadPool()
+{
+	_stopWorkers();
+}
+
+void ThreadPool::setNumThreads(unsigned int numThreads)
+{
+	if (numThreads < 1) { numThreads = 1; }
+
+	if (numThreads == getNumThreads()) { return; }
+
+	_stopWorkers();
+
+	// The calling thread counts as one of the threads
+	for (unsigned int i = 1; i < numThreads; i++)
+	{
+		m_workers.push_back(std::thread(&ThreadPool::_workerLoop, this));
+	}
+}
+
+unsigned int ThreadPool::getNumThreads() const
+{
+	return m_workers.size() + 1;
+}
+
+void ThreadPool::run(unsigned int numTasks, const Task& task)
+{
+	// Not worth waking the workers
+	if (m_workers.empty() || numTasks <= 1)
+	{
+		for (unsigned int i = 0; i < numTasks; i++)
+		{
+			task(i);
+		}
+
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		m_task = &task;
+		m_numTasks = numTasks;
+		m_nextTask = 0;
+		m_numTasksDone = 0;
+		m_batch++;
+	}
+
+	m_wakeCondition.notify_all();
+
+	_runTasks();
+
+	std::unique_lock<std::mutex> lock(m_mutex);
+
+	while (m_numTasksDone < m_numTasks)
+	{
+		m_doneCondition.wait(lock);
+	}
+
+	m_task = nullptr;
+}
+
+//--------------------------
+//	PRIVATES
+//--------------------------
+
+void ThreadPool::_stopWorkers()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_isStopping = true;
+	}
+
+	m_wakeCondition.notify_all();
+
+	for (unsigned int i = 0; i < m_workers.size(); i++)
+	{
+		m_workers[i].join();
+	}
+
+	m_workers.clear();
+	m_isStopping = false;
+}
+
+void ThreadPool::_workerLoop()
+{
+	unsigned int lastBatch = 0;
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		lastBatch = m_batch;
+	}
+
+	for (;;)
+	{
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+
+			while (!m_isStopping && m_batch == lastBatch)
+			{
+				m_wakeCondition.wait(lock);
+			}
+
+			if (m_isStopping) { return; }
+
+			lastBatch = m_batch;
+		}
+
+		_runTasks();
+	}
+}
+
+void ThreadPool::_runTasks()
+{
+	for (;;)
+	{
+		const Task* task;
+		unsigned int index;
+
+		// Take the next task
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+
+			if (m_nextTask >= m_numTasks) { return; }
+
+			task = m_task;
+			index = m_nextTask++;
+		}
+
+		(*task)(index);
+
+		bool isLastTask;
+
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			isLastTask = (++m_numTasksDone == m_numTasks);
+		}
+
+		if (isLastTask)
+		{
+			m_doneCondition.notify_all();
+		}
+	}
+}
+
+} // namespace lt
@@ -0,0 +1,86 @@
+#ifndef LTPHYS_THREADPOOL_HPP
+#define LTPHYS_THREADPOOL_HPP
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+namespace lt
+{
+
+////////////////////////////////////////////////////////////
+/// @brief A fixed set of worker threads that run batches of
+/// independent tasks.
+///
+/// The thread calling run works through the tasks along with
+/// the workers, and returns once every task is done. Tasks
+/// are handed out in index order, so tasks that should start
+/// first should have the lowest indices.
+///
+/// @author Leon Turpin
+/// @date November 2014
+////////////////////////////////////////////////////////////
+class ThreadPool
+{
+public:
+	typedef std::function<void(unsigned int)> Task;
+
+	////////////////////////////////////////////////////////////
+	/// @brief Default Constructor, starts with a single thread.
+	////////////////////////////////////////////////////////////
+	ThreadPool();
+
+	////////////////////////////////////////////////////////////
+	/// @brief Stops and joins the worker threads.
+	////////////////////////////////////////////////////////////
+	~ThreadPool();
+
+	////////////////////////////////////////////////////////////
+	/// @brief Set the number of threads that run tasks,
+	/// including the thread that calls run.
+	///
+	/// @param numThreads Number of threads, 1 runs every task
+	/// on the calling thread.
+	///
+	////////////////////////////////////////////////////////////
+	void setNumThreads(unsigned int numThreads);
+
+	unsigned int getNumThreads() const;
+
+	////////////////////////////////////////////////////////////
+	/// @brief Run task(i) for every i in [0, numTasks) and wait
+	/// for them all to finish.
+	///
+	/// @param numTasks The number of tasks to run.
+	/// @param task The function to call with each task's index.
+	///
+	////////////////////////////////////////////////////////////
+	void run(unsigned int numTasks, const Task& task);
+
+private:
+	std::vector<std::thread> m_workers;
+
+	std::mutex m_mutex;
+	std::condition_variable m_wakeCondition; // Signalled when a batch starts or the pool stops
+	std::condition_variable m_doneCondition; // Signalled when the last task of a batch is done
+
+	const Task* m_task; // The current batch's task
+	unsigned int m_numTasks; // Number of tasks in the current batch
+	unsigned int m_nextTask; // Index of the next task to hand out
+	unsigned int m_numTasksDone; // Number of finished tasks in the current batch
+	unsigned int m_batch; // Increases with each batch so workers can tell a new one has started
+	bool m_isStopping;
+
+	ThreadPool(const ThreadPool&);
+	ThreadPool& operator=(const ThreadPool&);
+
+	void _stopWorkers();
+	void _workerLoop();
+	void _runTasks();
+};
+
+} // namespace lt
+
+#endif // LTPHYS_THREADPOOL_HPP
@@ -1,5 +1,7 @@
 #include "World.hpp"
 
+#include <math.h>
+
 namespace lt
 {
 
@@ -8,25 +10,101 @@ namespace lt
 //--------------------------
 
 World::World()
-{}
+{
+	m_numSubsteps = 1;
+	m_fixedTimeStep = 1.0f / 60.0f;
+	m_maxSteps = 5;
+	m_timeAccumulator = 0;
+	m_integrator = INTEGRATOR_EULER;
+	m_isGyroscopicTorqueEnabled = false;
+	m_isSleepingEnabled = true;
+	m_linearSleepThreshold = 0.1f;
+	m_angularSleepThreshold = 0.1f;
+	m_timeToSleep = 0.5f;
+}
 
 void World::stepSimulation(const Scalar& timeStep)
 {
-	// Update forces
-	m_forceGenRegistry.updateForces(timeStep);
+	// Keep where the bodies were, to blend the rendered transforms from
+	m_bodyStorage.storePreviousStates();
 
-	// Move bodies
-	integrateBodies(timeStep);
+	if (m_numSubsteps > 1)
+	{
+		substepSimulation(timeStep);
+	}
+	else
+	{
+		// Update forces
+		m_forceGenRegistry.updateForces(timeStep);
 
-	// Clear Contacts, generate new ones, then resolve them
-	m_contactManifolds.clear();
-	ContactGenerator::generateContacts(m_rigidBodies, m_contactManifolds);
-	contactResolver.resolveContacts(m_contactManifolds);
+		// Move bodies
+		integrateBodies(timeStep);
+
+		// Clear Contacts, generate new ones, then resolve them island by island
+		m_contactManifolds.clear();
+		m_contactGenerator.generateContacts(m_rigidBodies, m_contactManifolds);
+		m_islandGenerator.generateIslands(m_rigidBodies, m_contactManifolds, m_forceGenRegistry, m_joints, m_articulations);
+		contactResolver.resolveContacts(m_islandGenerator.getIslands(), timeStep);
+		applyArticulationChanges(timeStep);
+	}
+
+	// Keep the applied impulses to warm start next update's matching contacts
+	m_contactGenerator.cacheImpulses(m_contactManifolds);
+
+	// Put islands that have come to rest to sleep
+	updateSleeping(timeStep);
+}
+
+unsigned int World::advanceSimulation(const Scalar& elapsedTime)
+{
+	// Time can't go backwards
+	m_timeAccumulator += (elapsedTime > 0) ? elapsedTime : 0;
+
+	unsigned int numSteps = 0;
+
+	while (m_timeAccumulator >= m_fixedTimeStep && numSteps < m_maxSteps)
+	{
+		stepSimulation(m_fixedTimeStep);
+
+		m_timeAccumulator -= m_fixedTimeStep;
+		numSteps++;
+	}
+
+	// Too far behind to catch up, drop the whole steps but keep the remainder
+	if (m_timeAccumulator >= m_fixedTimeStep)
+	{
+		m_timeAccumulator = scalar_fmod(m_timeAccumulator, m_fixedTimeStep);
+	}
+
+	return numSteps;
 }
 
+void World::setFixedTimeStep(const Scalar& fixedTimeStep) { m_fixedTimeStep = (fixedTimeStep > 0) ? fixedTimeStep : m_fixedTimeStep; }
+void World::setMaxSteps(unsigned int maxSteps) { m_maxSteps = (maxSteps > 0) ? maxSteps : 1; }
+const Scalar& World::getFixedTimeStep() const { return m_fixedTimeStep; }
+unsigned int World::getMaxSteps() const { return m_maxSteps; }
+const Scalar World::getInterpolationFactor() const { return m_timeAccumulator / m_fixedTimeStep; }
+
+const Transform World::getInterpolatedTransform(const RigidBody& body) const
+{
+	// Bodies in other worlds, or none, have nothing to blend
+	if (body.m_storage != &m_bodyStorage) { return body.getTransform(); }
+
+	return m_bodyStorage.getInterpolatedTransform(body.m_worldIndex, getInterpolationFactor());
+}
+
+void World::setNumSubsteps(unsigned int numSubsteps) { m_numSubsteps = (numSubsteps > 0) ? numSubsteps : 1; }
+unsigned int World::getNumSubsteps() const { return m_numSubsteps; }
+void World::setIntegrator(IntegratorType integrator) { m_integrator = integrator; }
+void World::setIsGyroscopicTorqueEnabled(bool isGyroscopicTorqueEnabled) { m_isGyroscopicTorqueEnabled = isGyroscopicTorqueEnabled; }
+IntegratorType World::getIntegrator() const { return m_integrator; }
+bool World::isGyroscopicTorqueEnabled() const { return m_isGyroscopicTorqueEnabled; }
+
 void World::addRigidBody(RigidBody* body)
 {
-	// Add the body
+	// Add the body, and move its state into the world's storage
+	body->m_worldIndex = m_bodyStorage.addBody();
+	body->_attach(&m_bodyStorage);
 	m_rigidBodies.push_back(body);
 }
 
@@ -38,9 +116,85 @@ void World::removeRigidBody(RigidBody* body)
 		// Check for a match
 		if (m_rigidBodies[i] == body)
 		{
+			// The body's neighbours might not be supported anymore
+			for (unsigned int j = 0; j < m_contactManifolds.size(); j++)
+			{
+				if (&m_contactManifolds[j].getBody0() == body)
+				{
+					m_contactManifolds[j].getBody1().setAwake(true);
+				}
+				else if (&m_contactManifolds[j].getBody1() == body)
+				{
+					m_contactManifolds[j].getBody0().setAwake(true);
+				}
+			}
+
+			// Joints can't hold a body that isn't there
+			for (unsigned int j = 0; j < m_joints.size(); )
+			{
+				if (&m_joints[j]->getBody0() == body || &m_joints[j]->getBody1() == body)
+				{
+					removeJoint(m_joints[j]);
+				}
+				else
+				{
+					j++;
+				}
+			}
+
+			// Nor can articulations
+			for (unsigned int j = 0; j < m_articulations.size(); )
+			{
+				bool isLink = false;
+
+				for (unsigned int k = 0; k < m_articulations[j]->getNumLinks(); k++)
+				{
+					isLink = isLink || (&m_articulations[j]->getLinkBody(k) == body);
+				}
+
+				if (isLink)
+				{
+					removeArticulation(m_articulations[j]);
+				}
+				else
+				{
+					j++;
+				}
+			}
+
+			// Bodies on either end of its springs aren't pulled anymore. Springs on other 
+			// bodies that point at it go too, rather than pulling towards where it was left.
+			const std::vector<ForceGenRegistration> &registrations = m_forceGenRegistry.getRegistrations();
+			std::vector<ForceGenRegistration> danglingSprings;
+
+			for (unsigned int j = 0; j < registrations.size(); j++)
+			{
+				RigidBody *other = registrations[j].forceGen->getConnectedBody();
+
+				if (registrations[j].body == body && other != nullptr && other != body)
+				{
+					other->setAwake(true);
+				}
+				else if (registrations[j].body != body && other == body)
+				{
+					registrations[j].body->setAwake(true);
+					danglingSprings.push_back(registrations[j]);
+				}
+			}
+
+			for (unsigned int j = 0; j < danglingSprings.size(); j++)
+			{
+				m_forceGenRegistry.remove(danglingSprings[j].body, danglingSprings[j].forceGen);
+			}
+
 			m_forceGenRegistry.remove(body);
-			// Swap this element and the end so as not to leave holes.
+			m_contactGenerator.removeBody(body);
+			// Give the body its state back
+			body->_detach();
+			// Swap this element and the end so as not to leave holes, the storage does the same.
+			m_bodyStorage.removeBody(i);
 			m_rigidBodies[i] = m_rigidBodies[m_rigidBodies.size() - 1]; 
+			m_rigidBodies[i]->m_worldIndex = i;
 			// Delete the duplicated element.
 			m_rigidBodies.pop_back();
 
@@ -59,6 +213,86 @@ void World::removeForceGenerator(RigidBody *body, ForceGenerator *forceGenerator
 	m_forceGenRegistry.remove(body, forceGenerator);
 }
 
+void World::addJoint(Joint *joint)
+{
+	m_joints.push_back(joint);
+
+	joint->getBody0().setAwake(true);
+	joint->getBody1().setAwake(true);
+}
+
+void World::removeJoint(Joint *joint)
+{
+	for (unsigned int i = 0; i < m_joints.size(); i++)
+	{
+		if (m_joints[i] == joint)
+		{
+			// The bodies might fall apart now
+			joint->getBody0().setAwake(true);
+			joint->getBody1().setAwake(true);
+
+			m_joints.erase(m_joints.begin() + i);
+
+			break;
+		}
+	}
+}
+
+const std::vector<Joint*>& World::getJoints()
+{
+	return m_joints;
+}
+
+void World::addArticulation(Articulation *articulation)
+{
+	m_articulations.push_back(articulation);
+
+	for (unsigned int i = 0; i < articulation->getNumLinks(); i++)
+	{
+		RigidBody &body = articulation->getLinkBody(i);
+
+		// A static base is fixed in place, and could be the base of other articulations too
+		if (body.getInvMass() == 0) { continue; }
+
+		body.m_articulation = articulation;
+		body.m_articulationParent = (i > 0) ? &articulation->getLinkBody(articulation->getParent(i)) : nullptr;
+		body._updateIsIntegrated();
+		body.setAwake(true);
+	}
+}
+
+void World::removeArticulation(Articulation *articulation)
+{
+	for (unsigned int i = 0; i < m_articulations.size(); i++)
+	{
+		if (m_articulations[i] == articulation)
+		{
+			// The links fall apart now
+			for (unsigned int j = 0; j < articulation->getNumLinks(); j++)
+			{
+				RigidBody &body = articulation->getLinkBody(j);
+
+				if (body.m_articulation == articulation)
+				{
+					body.m_articulation = nullptr;
+					body.m_articulationParent = nullptr;
+					body._updateIsIntegrated();
+					body.setAwake(true);
+				}
+			}
+
+			m_articulations.erase(m_articulations.begin() + i);
+
+			break;
+		}
+	}
+}
+
+const std::vector<Articulation*>& World::getArticulations()
+{
+	return m_articulations;
+}
+
 const std::vector<RigidBody*>& World::getRigidBodyList()
 {
 	return m_rigidBodies;
@@ -69,16 +303,148 @@ const std::vector<ContactManifold>& World::getContactManifolds()
 	return m_contactManifolds;
 }
 
+ContactGenerator& World::getContactGenerator()
+{
+	return m_contactGenerator;
+}
+
+ContactResolver& World::getContactResolver()
+{
+	return contactResolver;
+}
+
+const std::vector<Island>& World::getIslands()
+{
+	return m_islandGenerator.getIslands();
+}
+
+void World::setIsSleepingEnabled(bool isSleepingEnabled)
+{
+	m_isSleepingEnabled = isSleepingEnabled;
+
+	if (!isSleepingEnabled)
+	{
+		for (unsigned int i = 0; i < m_rigidBodies.size(); i++)
+		{
+			m_rigidBodies[i]->setAwake(true);
+		}
+	}
+}
+
+void World::setSleepThresholds(const Scalar& linearThreshold, const Scalar& angularThreshold)
+{
+	m_linearSleepThreshold = linearThreshold;
+	m_angularSleepThreshold = angularThreshold;
+}
+
+void World::setTimeToSleep(const Scalar& timeToSleep) { m_timeToSleep = timeToSleep; }
+bool World::isSleepingEnabled() const { return m_isSleepingEnabled; }
+const Scalar& World::getLinearSleepThreshold() const { return m_linearSleepThreshold; }
+const Scalar& World::getAngularSleepThreshold() const { return m_angularSleepThreshold; }
+const Scalar& World::getTimeToSleep() const { return m_timeToSleep; }
+
 //--------------------------
 //	PRIVATES			
 //--------------------------
 
 void World::integrateBodies(const Scalar& timeStep)
 {
-	// Integrate all the rigid bodies
-	for (unsigned int i = 0; i < m_rigidBodies.size(); i++)
+	// Integrate all the rigid bodies that are awake, straight from the storage
+	m_bodyStorage.integrate(timeStep, m_integrator, m_isGyroscopicTorqueEnabled);
+
+	// Articulations move their own links
+	for (unsigned int i = 0; i < m_articulations.size(); i++)
 	{
-		m_rigidBodies[i]->integrate(timeStep);
+		m_articulations[i]->integrate(timeStep);
+	}
+
+	// Catch up the bodies that were set or moved by articulations, once, before the solver's threads read them
+	m_bodyStorage.updateDerivedData();
+}
+
+void World::applyArticulationChanges(const Scalar& timeStep)
+{
+	// Take what the contacts did to the links back into the articulations' joints
+	for (unsigned int i = 0; i < m_articulations.size(); i++)
+	{
+		m_articulations[i]->applyLinkChanges(timeStep);
+	}
+}
+
+void World::substepSimulation(const Scalar& timeStep)
+{
+	Scalar substep = timeStep / m_numSubsteps;
+
+	// Generate contacts once for the whole step
+	m_contactManifolds.clear();
+	m_contactGenerator.generateContacts(m_rigidBodies, m_contactManifolds);
+	m_islandGenerator.generateIslands(m_rigidBodies, m_contactManifolds, m_forceGenRegistry, m_joints, m_articulations);
+
+	for (unsigned int i = 0; i < m_numSubsteps; i++)
+	{
+		m_forceGenRegistry.updateForces(substep);
+		integrateBodies(substep);
+
+		// Carry the contacts along with the bodies, instead of generating them again
+		for (unsigned int j = 0; j < m_contactManifolds.size(); j++)
+		{
+			if (m_contactManifolds[j].getBody0().isAwake() || m_contactManifolds[j].getBody1().isAwake())
+			{
+				m_contactManifolds[j].updateContacts();
+			}
+		}
+
+		// Each substep warm starts from the last one's impulses
+		contactResolver.resolveContacts(m_islandGenerator.getIslands(), substep);
+		applyArticulationChanges(substep);
+	}
+}
+
+void World::updateSleeping(const Scalar& timeStep)
+{
+	if (!m_isSleepingEnabled) { return; }
+
+	const Scalar linearThresholdSq = m_linearSleepThreshold * m_linearSleepThreshold;
+	const Scalar angularThresholdSq = m_angularSleepThreshold * m_angularSleepThreshold;
+
+	std::vector<Island> &islands = m_islandGenerator.getIslands();
+
+	for (unsigned int i = 0; i < islands.size(); i++)
+	{
+		if (!islands[i].isAwake) { continue; }
+
+		std::vector<RigidBody*> &bodies = islands[i].bodies;
+		Scalar minSleepTimer = SCALAR_MAX;
+
+		// Time how long each body has been at rest
+		for (unsigned int j = 0; j < bodies.size(); j++)
+		{
+			RigidBody &body = *bodies[j];
+			const Vec3 &vel = body.getVelocity();
+			const Vec3 &angVel = body.getAngularVelocity();
+
+			if (vel.dot(vel) < linearThresholdSq && angVel.dot(angVel) < angularThresholdSq)
+			{
+				body.m_sleepTimer += timeStep;
+			}
+			else
+			{
+				body.m_sleepTimer = 0;
+			}
+
+			minSleepTimer = (body.m_sleepTimer < minSleepTimer) ? body.m_sleepTimer : minSleepTimer;
+		}
+
+		// The island sleeps once all of its bodies have been at rest long enough.
+		if (minSleepTimer >= m_timeToSleep)
+		{
+			for (unsigned int j = 0; j < bodies.size(); j++)
+			{
+				bodies[j]->setAwake(false);
+			}
+
+			islands[i].isAwake = false;
+		}
 	}
 }
 
@@ -7,11 +7,15 @@
 #include "../lt3DMath/lt3DMath.hpp"
 
 #include "RigidBody.hpp"
+#include "BodyStorage.hpp"
 #include "ContactGenerator.hpp"
 #include "CollisionShape.hpp"
 #include "ForceGeneratorRegistry.hpp"
 #include "ContactResolver.hpp"
 #include "ContactManifold.hpp"
+#include "IslandGenerator.hpp"
+#include "Joint.hpp"
+#include "Articulation.hpp"
 
 namespace lt
 {
@@ -23,7 +27,9 @@ namespace lt
 /// shapes, constrains and such. So changes to those 
 /// objects outside the class will be affect the world.
 /// Make sure you remove the objects from the system
-/// before you delete them.
+/// before you delete them. The bodies' positions, 
+/// velocities and the like are kept in the world's own
+/// BodyStorage while they're in it.
 ///
 /// @author Leon Turpin
 /// @date February 2014
@@ -46,6 +52,98 @@ public:
 	///
 	////////////////////////////////////////////////////////////
 	void stepSimulation(const Scalar& timeStep);
+
+	////////////////////////////////////////////////////////////
+	/// @brief Advance the world by real time, in fixed steps.
+	///
+	/// The elapsed time is added to what was left over last
+	/// call, and stepSimulation is called with the fixed 
+	/// timestep for as many whole steps as that covers, so 
+	/// the simulation does the same thing whatever the frame
+	/// rate. At most the max number of steps are taken, any
+	/// time beyond that is dropped so a slow frame can't make
+	/// the next one slower still. What's left is less than a
+	/// step, see getInterpolationFactor.
+	///
+	/// @param elapsedTime Real time in seconds since the last
+	/// call.
+	///
+	/// @return The number of steps taken.
+	///
+	////////////////////////////////////////////////////////////
+	unsigned int advanceSimulation(const Scalar& elapsedTime);
+
+	////////////////////////////////////////////////////////////
+	/// @brief Set the timestep advanceSimulation steps the 
+	/// world by, 1/60th of a second by default.
+	////////////////////////////////////////////////////////////
+	void setFixedTimeStep(const Scalar& fixedTimeStep);
+
+	////////////////////////////////////////////////////////////
+	/// @brief Set the most steps advanceSimulation takes in
+	/// one call, 5 by default.
+	////////////////////////////////////////////////////////////
+	void setMaxSteps(unsigned int maxSteps);
+
+	const Scalar& getFixedTimeStep() const;
+	unsigned int getMaxSteps() const;
+
+	////////////////////////////////////////////////////////////
+	/// @brief Returns how far the real time is between the 
+	/// last two steps taken by advanceSimulation, 0 at the 
+	/// one before last and 1 at the last.
+	////////////////////////////////////////////////////////////
+	const Scalar getInterpolationFactor() const;
+
+	////////////////////////////////////////////////////////////
+	/// @brief Returns a body's transform blended between its 
+	/// last two steps by the interpolation factor, to render 
+	/// it smoothly at any frame rate. Only meaningful when 
+	/// the world is moved by advanceSimulation, a world moved
+	/// by stepSimulation alone renders a step behind.
+	///
+	/// @param body A rigid body in this world. Bodies that 
+	/// aren't get their own transform.
+	///
+	////////////////////////////////////////////////////////////
+	const Transform getInterpolatedTransform(const RigidBody& body) const;
+
+	////////////////////////////////////////////////////////////
+	/// @brief Set the number of substeps each call to 
+	/// stepSimulation is split into.
+	///
+	/// Contacts are generated once per step. Each substep then 
+	/// updates forces, moves the bodies, moves the contacts 
+	/// along with the bodies and resolves them. Stiff springs 
+	/// and tall stacks get the stability of shorter steps 
+	/// without paying for collision detection each time. 
+	/// Contacts that only start during the step are picked up 
+	/// next step.
+	///
+	/// @param numSubsteps Number of substeps, 1 disables 
+	/// substepping.
+	///
+	////////////////////////////////////////////////////////////
+	void setNumSubsteps(unsigned int numSubsteps);
+
+	unsigned int getNumSubsteps() const;
+
+	////////////////////////////////////////////////////////////
+	/// @brief Set how the bodies' angles are moved each 
+	/// update, INTEGRATOR_EULER by default. See IntegratorType.
+	////////////////////////////////////////////////////////////
+	void setIntegrator(IntegratorType integrator);
+
+	////////////////////////////////////////////////////////////
+	/// @brief Enable or disable the gyroscopic torque, which
+	/// makes bodies spinning off their principal axes wobble
+	/// like real ones. Disabled by default, it's mostly seen 
+	/// on long thin bodies spinning fast.
+	////////////////////////////////////////////////////////////
+	void setIsGyroscopicTorqueEnabled(bool isGyroscopicTorqueEnabled);
+
+	IntegratorType getIntegrator() const;
+	bool isGyroscopicTorqueEnabled() const;
 	
 	////////////////////////////////////////////////////////////
 	/// @brief Register a rigid body to this world. 
@@ -58,6 +156,10 @@ public:
 	////////////////////////////////////////////////////////////
 	/// @brief Removes a rigid body from the world.
 	///
+	/// Its force generators, joints and articulations go with
+	/// it, as do force generators on other bodies connected 
+	/// to it. The bodies it touched or was connected to wake.
+	///
 	/// @param body Rigid body to remove.
 	///
 	////////////////////////////////////////////////////////////	
@@ -83,6 +185,53 @@ public:
 	////////////////////////////////////////////////////////////		
 	void removeForceGenerator(RigidBody *body, ForceGenerator *forceGenerator);
 
+	////////////////////////////////////////////////////////////		
+	/// @brief Add a joint to the world. Both of the joint's 
+	/// bodies should already be in the world, the joint is
+	/// ignored while either isn't.
+	///
+	/// @param joint Joint to add to the world.
+	///
+	////////////////////////////////////////////////////////////		
+	void addJoint(Joint *joint);
+
+	////////////////////////////////////////////////////////////		
+	/// @brief Remove a joint from the world.
+	///
+	/// @param joint Joint to remove from the world.
+	///
+	////////////////////////////////////////////////////////////		
+	void removeJoint(Joint *joint);
+
+	////////////////////////////////////////////////////////////		
+	/// @brief Returns a vector of all joints in the world.
+	////////////////////////////////////////////////////////////	
+	const std::vector<Joint*>& getJoints();
+
+	////////////////////////////////////////////////////////////		
+	/// @brief Add an articulation to the world. All of its 
+	/// link bodies should already be in the world, the world
+	/// stops integrating them itself.
+	///
+	/// @param articulation Articulation to add to the world.
+	///
+	////////////////////////////////////////////////////////////		
+	void addArticulation(Articulation *articulation);
+
+	////////////////////////////////////////////////////////////		
+	/// @brief Remove an articulation from the world. Its link
+	/// bodies stay in the world as free bodies.
+	///
+	/// @param articulation Articulation to remove from the world.
+	///
+	////////////////////////////////////////////////////////////		
+	void removeArticulation(Articulation *articulation);
+
+	////////////////////////////////////////////////////////////		
+	/// @brief Returns a vector of all articulations in the world.
+	////////////////////////////////////////////////////////////	
+	const std::vector<Articulation*>& getArticulations();
+
 	////////////////////////////////////////////////////////////		
 	/// @brief Returns a vector of all rigid bodies in the world.
 	////////////////////////////////////////////////////////////	
@@ -94,13 +243,80 @@ public:
 	////////////////////////////////////////////////////////////	
 	const std::vector<ContactManifold>& World::getContactManifolds();	
 
+	////////////////////////////////////////////////////////////		
+	/// @brief Returns the world's contact generator, so its
+	/// settings can be changed.
+	////////////////////////////////////////////////////////////	
+	ContactGenerator& getContactGenerator();
+
+	////////////////////////////////////////////////////////////		
+	/// @brief Returns the world's contact resolver, so its
+	/// settings can be changed.
+	////////////////////////////////////////////////////////////	
+	ContactResolver& getContactResolver();
+
+	////////////////////////////////////////////////////////////		
+	/// @brief Returns the islands the world's bodies were 
+	/// grouped into last update.
+	////////////////////////////////////////////////////////////	
+	const std::vector<Island>& getIslands();
+
+	////////////////////////////////////////////////////////////		
+	/// @brief Enable or disable putting islands to sleep.
+	/// Disabling sleeping wakes every body.
+	////////////////////////////////////////////////////////////	
+	void setIsSleepingEnabled(bool isSleepingEnabled);
+
+	////////////////////////////////////////////////////////////		
+	/// @brief Set the speeds under which a body is considered
+	/// at rest.
+	///
+	/// @param linearThreshold Linear speed threshold.
+	/// @param angularThreshold Angular speed threshold in radians per second.
+	///
+	////////////////////////////////////////////////////////////	
+	void setSleepThresholds(const Scalar& linearThreshold, const Scalar& angularThreshold);
+
+	////////////////////////////////////////////////////////////		
+	/// @brief Set how long every body in an island must stay 
+	/// at rest before the island is put to sleep.
+	////////////////////////////////////////////////////////////	
+	void setTimeToSleep(const Scalar& timeToSleep);
+
+	bool isSleepingEnabled() const;
+	const Scalar& getLinearSleepThreshold() const;
+	const Scalar& getAngularSleepThreshold() const;
+	const Scalar& getTimeToSleep() const;
+
 private:
 	std::vector<RigidBody*> m_rigidBodies;
+	BodyStorage m_bodyStorage; // The bodies' state, in the same order as m_rigidBodies
 	ForceGeneratorRegistry m_forceGenRegistry;
+	std::vector<Joint*> m_joints;
+	std::vector<Articulation*> m_articulations;
+	ContactGenerator m_contactGenerator;
 	ContactResolver contactResolver;
+	IslandGenerator m_islandGenerator;
 	std::vector<ContactManifold> m_contactManifolds;
 
+	unsigned int m_numSubsteps;
+
+	Scalar m_fixedTimeStep;
+	unsigned int m_maxSteps;
+	Scalar m_timeAccumulator; // Real time not yet simulated by advanceSimulation
+
+	IntegratorType m_integrator;
+	bool m_isGyroscopicTorqueEnabled;
+
+	bool m_isSleepingEnabled;
+	Scalar m_linearSleepThreshold;
+	Scalar m_angularSleepThreshold;
+	Scalar m_timeToSleep;
+
 	void integrateBodies(const Scalar& timeStep);
+	void applyArticulationChanges(const Scalar& timeStep);
+	void substepSimulation(const Scalar& timeStep);
+	void updateSleeping(const Scalar& timeStep);
 };
 
 } // namespace lt
@@ -10,7 +10,18 @@
 #include "FGenGravity.hpp"
 #include "FGenSpring.hpp"
 
+#include "Joint.hpp"
+#include "JointBallSocket.hpp"
+#include "JointHinge.hpp"
+#include "JointSlider.hpp"
+#include "JointFixed.hpp"
+#include "JointDistance.hpp"
+
+#include "Articulation.hpp"
+
 #include "World.hpp"
+#include "Island.hpp"
+#include "IslandGenerator.hpp"
 
 #include "ContactGenerator.hpp"
 #include "ContactResolver.hpp"